@@ -1,3 +1,6 @@
+#ifndef ALGORITHMS_HPP
+#define ALGORITHMS_HPP
+
 #include <vector>
 #include <cstdlib>
 #include <ctime>
@@ -5,247 +8,566 @@
 #include <limits>
 #include <algorithm>
 #include <random>
+#include <set>
+#include <cmath>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+#include <functional>
+#include <mutex>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_random.hpp"
+#include "2105120_parallel.hpp"
+#include "2105120_bitslice.hpp"
+#include "2105120_dense.hpp"
+#include "2105120_path_relinking.hpp"
+#include "2105120_tabu.hpp"
+#include "2105120_vnd.hpp"
+#include "2105120_timing.hpp"
+#include "2105120_trace.hpp"
 
 using namespace std;
 
-int calculateCutWeight(const unordered_set<int> & partition_x, const unordered_set<int> & partition_y, const vector<vector<int>> & weights) {
-    int cutWeight = 0;
+struct RandomizedCutResult {
+    int average_cut_weight;
+    int best_cut_weight;
+};
+
+// Evaluates `trials` uniformly random partitions (n by default, rounded up to a whole batch).
+// Partitions are drawn 256 at a time, four words per vertex, and evaluated in one AVX2 pass or in
+// four 64 bit passes. The draws do not depend on the CPU, so neither do the results nor the state
+// gen is left in.
+RandomizedCutResult RandomizedHeuristicMaxCut(const Graph & graph, RandomStream & gen, int trials = 0) {
+    TRACE_SCOPE("RandomizedHeuristicMaxCut");
+    int n = graph.n;
+    if (trials <= 0) trials = max(n, 1);
+
+    bool wide = cpuSupportsAVX2();
+    const int words_per_vertex = 4;
+    const int batch_size = 64 * words_per_vertex;
+
+    vector<uint64_t> masks(words_per_vertex * (n + 1));
+    vector<long long> cuts(batch_size);
+    long long totalCutWeight = 0; // Total weight of the cuts
+    long long best_cut_weight = numeric_limits<long long>::min();
+    int evaluated = 0;
+
+    while (evaluated < trials) {
+        // Bit l of the mask of a vertex is its side in partition l of this batch
+        for (auto & mask : masks) mask = gen();
+
+        if (wide) evaluateRandomCuts256(graph, masks.data(), cuts.data());
+        else {
+            for (int word = 0; word < words_per_vertex; word++) evaluateRandomCuts64(graph, masks.data() + word, cuts.data() + 64 * word, words_per_vertex);
+        }
 
-    for (auto u : partition_x) {
-        for (auto v : partition_y) {
-            cutWeight += weights[u-1][v-1];
+        for (auto cut_weight : cuts) {
+            totalCutWeight += cut_weight;
+            best_cut_weight = max(best_cut_weight, cut_weight);
         }
+        evaluated += batch_size;
     }
 
-    return cutWeight;
+    return {(int)(totalCutWeight / evaluated), (int)best_cut_weight}; // Average and best cut weight
 }
 
 
-int RandomizedHeuristicMaxCut(int n, const vector<pair<pair<int,int>, int>> & edges) {
-    int totalCutWeight = 0; // Total weight of the cut
-
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(1, n);
+// Incremental state of the constructive phase.
+// sigma_x[v] and sigma_y[v] are the total weights of the edges from v to the vertices already placed in
+// partition x and partition y. Placing a vertex only updates the sums of its neighbors.
+struct ConstructionState {
+    const Graph & graph;
+    vector<int> sigma_x, sigma_y;
+    vector<char> placed; // 0 for unassigned, 'x' or 'y' otherwise, 1 indexed
+    int cut_weight = 0; // weight of the edges between the placed vertices of x and y
 
+    ConstructionState(const Graph & graph) : graph(graph), sigma_x(graph.n + 1, 0), sigma_y(graph.n + 1, 0), placed(graph.n + 1, 0) {}
 
-    for (int i= 0; i < n; i++ ) {
-        unordered_set<int> x, y;
+    void place(int v, char side) {
+        TRACE_COUNT(TRACE_CONSTRUCTION_STEPS, 1);
+        placed[v] = side;
+        cut_weight += side == 'x' ? sigma_y[v] : sigma_x[v];
+        vector<int> & sigma = side == 'x' ? sigma_x : sigma_y;
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) sigma[graph.neighbor[i]] += graph.neighbor_weight[i];
+    }
 
-        for (int j = 1; j <= n; j++) {
-            // Randomly assign vertices to partition x or y
-            int random_partition = dis(gen) % 2;
-            if(random_partition == 0) x.insert(j);
-            else y.insert(j);
-        }
+    // The vertex goes to the side opposite to the partition it is more strongly connected to
+    char bestSide(int v) const {
+        return sigma_y[v] > sigma_x[v] ? 'x' : 'y';
+    }
 
-        int cut_weight = 0; // Weight of the current cut
+    Partition partition() const {
+        Partition partition;
+        partition.in_x.assign(graph.n + 1, 0);
+        for (int v = 1; v <= graph.n; v++) partition.in_x[v] = placed[v] == 'x';
+        partition.cut_weight = cut_weight;
+        return partition;
+    }
+};
 
-        for (auto & edge : edges) {
-            int u = edge.first.first;
-            int v = edge.first.second;
-            int weight = edge.second;
 
-            bool u_in_x = x.find(u) != x.end();
-            bool v_in_x = x.find(v) != x.end();
-            bool u_in_y = y.find(u) != y.end();
-            bool v_in_y = y.find(v) != y.end();
-            bool is_cut = u_in_x && v_in_y || u_in_y && v_in_x; // Check if the edge is cut
+// Endpoints of the maximum weight edge, used to seed the constructive algorithms
+pair<int,int> maxWeightEdge(const Graph & graph) {
+    if (graph.edges.empty()) return {1, graph.n > 1 ? 2 : 1};
 
-            if (is_cut) cut_weight += weight;
-        }
-        totalCutWeight = totalCutWeight + cut_weight;
+    const Edge * max_edge = &graph.edges[0];
+    for (auto & edge : graph.edges) {
+        if (edge.weight > max_edge->weight) max_edge = &edge;
     }
-
-    return totalCutWeight / n; // Return the average cut weight
+    return {max_edge->u, max_edge->v};
 }
 
 
-pair<unordered_set<int>, unordered_set<int>> GreedyMaxCut(int n, const vector<vector<int>> & weights) {
-    unordered_set<int> partition_x, partition_y;
+Partition GreedyMaxCut(const Graph & graph) {
+    TRACE_SCOPE("GreedyMaxCut");
+    ConstructionState state(graph);
 
-    // get the maximum weight of the edges
-    int max_weight = 0, max_u = -1, max_v = -1;
-    for(int i = 1; i <= n; i++) {
-        for(int j = 1; j <= n; j++) {
-            if (weights[i-1][j-1] > max_weight) {
-                max_weight = weights[i-1][j-1];
-                max_u = i;
-                max_v = j;
-            }
-        }
+    auto [max_u, max_v] = maxWeightEdge(graph);
+    state.place(max_u, 'x');
+    if (max_v != max_u) state.place(max_v, 'y');
+
+    for (int i = 1; i <= graph.n; i++) {
+        if(state.placed[i]) continue; // Skip the vertices already in the partitions
+        state.place(i, state.bestSide(i));
     }
 
-    partition_x.insert(max_u);
-    partition_y.insert(max_v);
+    return state.partition();
+}
+
+
 
+// (value, vertex) pairs with O(log n) k-th element queries, used to sample the RCL.
+// Placing a vertex re-keys each unassigned neighbor in two trees, so the construction is O(m log n).
+// Integer buckets would drop the log factor only for small weights: the greedy values span up to the
+// total absolute weight, and the RCL is drawn by rank in (value, vertex) order so that
+// SemiGreedyMaxCutDense reproduces the same partition, which needs the order statistics anyway.
+typedef __gnu_pbds::tree<pair<int,int>, __gnu_pbds::null_type, less<pair<int,int>>, __gnu_pbds::rb_tree_tag, __gnu_pbds::tree_order_statistics_node_update> ordered_set;
 
-    for (int i = 1; i <= n; i++) {
-        if(i == max_u || i == max_v) continue; // Skip the vertices already in the partitions
-        int weight_x = 0, weight_y = 0;
+Partition SemiGreedyMaxCut(const Graph & graph, double alpha, RandomStream & gen) {
+    TRACE_SCOPE("SemiGreedyMaxCut");
+    int n = graph.n;
+    ConstructionState state(graph);
 
-        for(auto u : partition_y) weight_x += weights[i-1][u-1];
-        for(auto v : partition_x) weight_y += weights[i-1][v-1];
+    // Unassigned vertices ordered by greedy value max(sigma_x, sigma_y) and by min(sigma_x, sigma_y)
+    ordered_set greedy_values;
+    set<pair<int,int>> min_values;
 
-        if(weight_x > weight_y) partition_x.insert(i);
-        else partition_y.insert(i);
+    auto [max_u, max_v] = maxWeightEdge(graph);
+    state.placed[max_u] = 'x';
+    if (max_v != max_u) state.placed[max_v] = 'y';
+    for (int v = 1; v <= n; v++) {
+        if(!state.placed[v]) {
+            greedy_values.insert({0, v});
+            min_values.insert({0, v});
+        }
     }
 
-    return {partition_x, partition_y};
-}
+    auto place = [&](int v, char side) {
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+            int u = graph.neighbor[i];
+            if(state.placed[u]) continue;
+            greedy_values.erase({max(state.sigma_x[u], state.sigma_y[u]), u});
+            min_values.erase({min(state.sigma_x[u], state.sigma_y[u]), u});
+        }
+        state.place(v, side);
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+            int u = graph.neighbor[i];
+            if(state.placed[u]) continue;
+            greedy_values.insert({max(state.sigma_x[u], state.sigma_y[u]), u});
+            min_values.insert({min(state.sigma_x[u], state.sigma_y[u]), u});
+        }
+    };
 
+    place(max_u, 'x');
+    if (max_v != max_u) place(max_v, 'y');
 
+    while(!greedy_values.empty()) {
+        int wmin = min_values.begin()->first;
+        int wmax = greedy_values.rbegin()->first;
 
-pair<unordered_set<int>, unordered_set<int>> SemiGreedyMaxCut(int n, const vector<vector<int>> & weights, double alpha) {
-    unordered_set<int> partition_x, partition_y;
-    vector<bool> assigned(n + 1, false); // Track assigned vertices, 1 indexed
+        double mu = wmin + alpha * (wmax - wmin);
 
-    // get the maximum weight of the edges
-    int max_weight = 0, max_u = -1, max_v = -1;
-    for(int i = 1; i <= n; i++) {
-        for(int j = 1; j <= n; j++) {
-            if (weights[i-1][j-1] > max_weight) {
-                max_weight = weights[i-1][j-1];
-                max_u = i;
-                max_v = j;
-            }
+        // Restricted Candidate List: the vertices with greedy value >= mu, a suffix of greedy_values
+        int first_index = greedy_values.order_of_key({(int)ceil(mu), numeric_limits<int>::min()});
+        int rcl_size = greedy_values.size() - first_index;
+
+        if(rcl_size <= 0) {
+            first_index = greedy_values.size() - 1;
+            rcl_size = 1;
         }
-    }
+        TRACE_COUNT(TRACE_RCL_BUILDS, 1);
+        TRACE_COUNT(TRACE_RCL_CANDIDATES, rcl_size);
 
-    partition_x.insert(max_u);
-    partition_y.insert(max_v);
-    assigned[max_u] = true;
-    assigned[max_v] = true;
+        // Randomly select a vertex from RCL
+        uniform_int_distribution<> dis(0, rcl_size - 1);
+        int selected_vertex = greedy_values.find_by_order(first_index + dis(gen))->second;
 
-    int remaining_vertices = n - 2; // Remaining vertices to assign
+        greedy_values.erase({max(state.sigma_x[selected_vertex], state.sigma_y[selected_vertex]), selected_vertex});
+        min_values.erase({min(state.sigma_x[selected_vertex], state.sigma_y[selected_vertex]), selected_vertex});
+        place(selected_vertex, state.bestSide(selected_vertex));
+    }
 
-    random_device rd;
-    mt19937 gen(rd());
+    return state.partition();
+}
 
-    while(remaining_vertices > 0) {
-        vector<int> candidates;
-        vector<int> greedy_values;
 
-        int wmin = numeric_limits<int>::max();
-        int wmax = numeric_limits<int>::min();
 
-        for (int v = 1; v <= n; v++) {
-            if(assigned[v]) continue; // Skip already assigned vertices
+// SemiGreedyMaxCut on a dense matrix. The side sums are updated a whole row at a time and the RCL is
+// found by scanning the unassigned vertices, O(n) per step. It draws from gen exactly like
+// SemiGreedyMaxCut and picks the RCL element of the same rank in (greedy value, vertex) order, so
+// both return the same partition.
+Partition SemiGreedyMaxCutDense(const Graph & graph, const DenseMatrix & matrix, double alpha, RandomStream & gen) {
+    TRACE_SCOPE("SemiGreedyMaxCutDense");
+    int n = graph.n;
+    DenseConstructionState state(matrix);
 
-            int sigma_x = 0, sigma_y = 0;
+    auto [max_u, max_v] = maxWeightEdge(graph);
+    state.place(max_u, 'x');
+    if (max_v != max_u) state.place(max_v, 'y');
 
-            for (auto u : partition_x) sigma_x += weights[v-1][u-1];
-            for (auto u : partition_y) sigma_y += weights[v-1][u-1];
+    vector<int> unassigned;
+    for (int v = 1; v <= n; v++) {
+        if (!state.placed[v]) unassigned.push_back(v);
+    }
+    vector<pair<int,int>> rcl;
 
-            int greedy_value = max(sigma_x, sigma_y);
-            greedy_values.push_back(greedy_value);
-            candidates.push_back(v);
-            wmin = min(wmin, min(sigma_x, sigma_y));
-            wmax = max(wmax, max(sigma_x, sigma_y));
+    while (!unassigned.empty()) {
+        int wmin = numeric_limits<int>::max(), wmax = numeric_limits<int>::min();
+        for (int v : unassigned) {
+            wmin = min(wmin, min(state.sigma_x[v], state.sigma_y[v]));
+            wmax = max(wmax, max(state.sigma_x[v], state.sigma_y[v]));
         }
 
         double mu = wmin + alpha * (wmax - wmin);
+        int threshold = (int)ceil(mu);
 
-        vector<int> RCL; // Restricted Candidate List
-
-        for (int i =0 ; i < candidates.size(); i++) {
-            if(greedy_values[i] >= mu) RCL.push_back(candidates[i]);
+        rcl.clear();
+        for (int v : unassigned) {
+            int greedy_value = max(state.sigma_x[v], state.sigma_y[v]);
+            if (greedy_value >= threshold) rcl.push_back({greedy_value, v});
         }
-
-        if(RCL.empty()) {
-            int best_index = max_element(greedy_values.begin(), greedy_values.end()) - greedy_values.begin();
-            RCL.push_back(candidates[best_index]);
+        if (rcl.empty()) { // like SemiGreedyMaxCut, fall back to the largest (greedy value, vertex)
+            for (int v : unassigned) rcl.push_back({max(state.sigma_x[v], state.sigma_y[v]), v});
+            rcl = {*max_element(rcl.begin(), rcl.end())};
         }
+        TRACE_COUNT(TRACE_RCL_BUILDS, 1);
+        TRACE_COUNT(TRACE_RCL_CANDIDATES, rcl.size());
 
-        // Randomly select a vertex from RCL
-
-        uniform_int_distribution<> dis(0, RCL.size() - 1);
-        int random_index = dis(gen);
-        int selected_vertex = RCL[random_index];
-        assigned[selected_vertex] = true;
-        remaining_vertices--;
-        int weight_x = 0, weight_y = 0;
-
-        for (auto u : partition_y) weight_x += weights[selected_vertex-1][u-1];
-        for (auto u : partition_x) weight_y += weights[selected_vertex-1][u-1];
-
-        if (weight_x > weight_y) partition_x.insert(selected_vertex);
-        else partition_y.insert(selected_vertex);
+        uniform_int_distribution<> dis(0, (int)rcl.size() - 1);
+        auto selected = rcl.begin() + dis(gen);
+        nth_element(rcl.begin(), selected, rcl.end());
+        int selected_vertex = selected->second;
 
+        state.place(selected_vertex, state.bestSide(selected_vertex));
+        unassigned.erase(find(unassigned.begin(), unassigned.end(), selected_vertex));
     }
 
-    return {partition_x, partition_y};
+    return state.partition();
 }
 
 
 
-int LocalSearchMaxCut(int n, const vector<vector<int>> & weights, unordered_set<int> & partition_x, unordered_set<int> & partition_y) {
+int LocalSearchMaxCut(const Graph & graph, Partition & partition) {
+    TRACE_SCOPE("LocalSearchMaxCut");
+    GainState state(graph, partition);
     bool improved = true;
     int iterations = 0;
 
     while(improved) {
-        improved = false;
         iterations++;
+        TRACE_COUNT(TRACE_SWEEPS, 1);
+        TRACE_COUNT(TRACE_GAIN_EVALUATIONS, graph.n);
 
         int delta_max = numeric_limits<int>::min();
         int best_vertex = -1;
-        bool best_partition = false; // true for x, false for y
-
-        for (int v = 1; v <= n ; v++) {
-            bool vertex_in_x = partition_x.find(v) != partition_x.end();
-            
-            int sigma_same = 0, sigma_other = 0;
-
-            if(vertex_in_x) {
-                for (auto u : partition_x) sigma_same += weights[v-1][u-1];
-                for (auto u : partition_y) sigma_other += weights[v-1][u-1];
-            } else {
-                for (auto u : partition_y) sigma_same += weights[v-1][u-1];
-                for (auto u : partition_x) sigma_other += weights[v-1][u-1];
-            }
 
-            int delta = sigma_same - sigma_other;
-
-            if ( delta > delta_max) {
-                delta_max = delta;
+        for (int v = 1; v <= graph.n ; v++) {
+            if (state.gain[v] > delta_max) {
+                delta_max = state.gain[v];
                 best_vertex = v;
-                best_partition = !vertex_in_x; // Swap the partition
             }
-            
         }
 
-        if(best_vertex != -1 && delta_max > 0) {
-            if (best_partition) {
-                partition_x.insert(best_vertex);
-                partition_y.erase(best_vertex);
-            } else {
-                partition_y.insert(best_vertex);
-                partition_x.erase(best_vertex);
+        improved = best_vertex != -1 && delta_max > 0;
+        if (improved) state.flip(best_vertex);
+    }
+    return iterations; // Return the number of iterations
+}
+
+// LocalSearchMaxCut on a dense matrix, every flip is one signed row update. Same moves and result.
+int LocalSearchMaxCutDense(const DenseMatrix & matrix, Partition & partition) {
+    TRACE_SCOPE("LocalSearchMaxCutDense");
+    DenseGainState state(matrix, partition);
+    bool improved = true;
+    int iterations = 0;
+
+    while(improved) {
+        iterations++;
+        TRACE_COUNT(TRACE_SWEEPS, 1);
+        TRACE_COUNT(TRACE_GAIN_EVALUATIONS, matrix.n);
+
+        int delta_max = numeric_limits<int>::min();
+        int best_vertex = -1;
+
+        for (int v = 1; v <= matrix.n; v++) {
+            if (state.gain[v] > delta_max) {
+                delta_max = state.gain[v];
+                best_vertex = v;
             }
-            improved = true; // Improvement found
-        } else {
-            improved = false; // No improvement found
         }
+
+        improved = best_vertex != -1 && delta_max > 0;
+        if (improved) state.flip(best_vertex);
     }
-    return iterations; // Return the number of iterations
+    return iterations;
 }
 
 
-pair<unordered_set<int>, unordered_set<int>> GRASP(int n, const vector<vector<int>> & weights, int iterations, double alpha) {
-    pair<unordered_set<int>, unordered_set<int>> best_partition = SemiGreedyMaxCut(n, weights, alpha);
-    LocalSearchMaxCut(n, weights, best_partition.first, best_partition.second);
-    int best_cut_weight = calculateCutWeight(best_partition.first, best_partition.second, weights);
+// A new best cut found at `elapsed` seconds after GRASP started
+struct ImprovementEvent {
+    double elapsed;
+    int cut_weight;
+    int iteration;
+};
+
+struct GRASPStats {
+    int iterations = 0; // iterations that ran to completion
+    double elapsed = 0;
+    double time_to_target = -1; // seconds until a cut >= options.target was found, -1 if it was not
+    vector<ImprovementEvent> improvements;
+
+    // Reactive GRASP only: final probability and number of uses of every alpha
+    vector<double> alphas, alpha_probabilities;
+    vector<int> alpha_uses;
+};
+
+
+// Alpha selection of reactive GRASP. Alpha k is drawn with probability proportional to
+// q_k = ((A_k - worst) / (best - worst))^delta, where A_k is the average cut of the iterations that
+// used it and best and worst are the extreme cuts seen so far. Unused alphas keep q = 1.
+class ReactiveAlpha {
+    vector<double> alphas;
+    vector<double> probabilities;
+    vector<double> total;
+    vector<int> uses;
+    double amplification;
+    int best = numeric_limits<int>::min(), worst = numeric_limits<int>::max();
+
+public:
+    ReactiveAlpha(const vector<double> & alphas, double amplification)
+        : alphas(alphas), probabilities(alphas.size(), 1.0 / alphas.size()), total(alphas.size(), 0), uses(alphas.size(), 0), amplification(amplification) {}
+
+    int sample(RandomStream & gen) const {
+        discrete_distribution<int> dis(probabilities.begin(), probabilities.end());
+        return dis(gen);
+    }
 
-    for(int i = 1 ; i < iterations; i++) {
-        auto partition = SemiGreedyMaxCut(n, weights, alpha);
-        LocalSearchMaxCut(n, weights, partition.first, partition.second);
-        int cut_weight = calculateCutWeight(partition.first, partition.second, weights);
+    double alpha(int index) const { return alphas[index]; }
 
-        if (cut_weight > best_cut_weight) {
-            best_cut_weight = cut_weight;
-            best_partition = partition;
+    void record(int index, int cut_weight) {
+        total[index] += cut_weight;
+        uses[index]++;
+        best = max(best, cut_weight);
+        worst = min(worst, cut_weight);
+    }
+
+    void updateProbabilities() {
+        if (best <= worst) return;
+        vector<double> q(alphas.size(), 1.0);
+        for (size_t k = 0; k < alphas.size(); k++) {
+            if (uses[k] > 0) q[k] = pow((total[k] / uses[k] - worst) / (best - worst), amplification);
         }
+        double sum = 0;
+        for (double value : q) sum += value;
+        if (sum <= 0) return;
+        for (size_t k = 0; k < alphas.size(); k++) probabilities[k] = q[k] / sum;
+    }
+
+    void report(GRASPStats & stats) const {
+        stats.alphas = alphas;
+        stats.alpha_probabilities = probabilities;
+        stats.alpha_uses = uses;
     }
+};
+
+enum PathRelinking {
+    NO_RELINKING,
+    FORWARD_RELINKING,  // from the new local optimum towards an elite partition
+    BACKWARD_RELINKING  // from the elite partition towards the new local optimum
+};
+
+struct GRASPOptions {
+    int iterations = 50;
+    double alpha = 0.5;
+    uint64_t seed = 0; // master seed, iteration i draws from RandomStream(seed, i)
+    int threads = 1;
+    int target = numeric_limits<int>::max(); // stop early once a cut of at least this weight is found
+
+    PathRelinking relinking = BACKWARD_RELINKING;
+    int elite_size = 10;
+    double elite_min_distance = 0.01; // fraction of n a new elite member must differ in
+    int batch_size = 16; // iterations that share one snapshot of the elite pool and of the reactive alpha probabilities
+
+    // Reactive GRASP: alpha of every iteration is drawn from reactive_alphas instead of fixed
+    bool reactive = false;
+    vector<double> reactive_alphas = {0.0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0};
+    double reactive_amplification = 10; // delta, larger values favor the best alphas more strongly
+
+    const DenseMatrix * dense = nullptr; // dense weights of the graph, construction and local search use them when set
+    bool variable_neighborhood_descent = false; // use VND instead of best-improvement local search
+    VNDOptions vnd;
+    bool breakout_local_search = false; // improve every local optimum further with breakout local search
+    TabuOptions tabu;
+
+    // Anytime mode: with a time limit, iterations keep starting until the limit and options.iterations is ignored
+    double time_limit = 0; // seconds, 0 means run options.iterations iterations
+    function<void(const ImprovementEvent &)> on_improvement; // called for every new best cut, from any thread
+};
+
+
+// One GRASP iteration: semi-greedy construction and local search (or VND), optionally followed by breakout
+// local search, then path relinking between the local optimum and an elite partition when a pool
+// is given. Returns the best partition it saw.
+Partition GRASPIteration(const Graph & graph, const GRASPOptions & options, int iteration, double alpha, const ElitePool * pool) {
+    TRACE_SCOPE("GRASPIteration");
+    RandomStream gen(options.seed, iteration);
+    auto improve = [&](Partition & partition) {
+        if (options.variable_neighborhood_descent) VariableNeighborhoodDescent(graph, partition, gen, options.vnd);
+        else if (options.dense != nullptr) LocalSearchMaxCutDense(*options.dense, partition);
+        else LocalSearchMaxCut(graph, partition);
+        checkCutWeight(graph, partition);
+    };
+
+    Partition partition = options.dense != nullptr ? SemiGreedyMaxCutDense(graph, *options.dense, alpha, gen)
+                                                   : SemiGreedyMaxCut(graph, alpha, gen);
+    improve(partition);
+    if (options.breakout_local_search) BreakoutLocalSearchMaxCut(graph, partition, gen, options.tabu);
+
+    if (pool == nullptr || pool->empty()) return partition;
+    const Partition * guide = pool->selectGuide(partition, gen);
+    if (guide == nullptr) return partition;
+
+    Partition relinked = options.relinking == FORWARD_RELINKING ? pathRelinking(graph, partition, *guide)
+                                                                : pathRelinking(graph, *guide, partition);
+    improve(relinked);
+
+    return relinked.cut_weight > partition.cut_weight ? relinked : partition;
+}
+
+
+// Iterations run in parallel, each with its own random stream. With path relinking or reactive
+// alpha, iterations run in batches of options.batch_size that share a snapshot of the elite pool and
+// the alpha probabilities, which are updated in iteration order between batches.
+// The best cut is reduced by (cut weight, lowest iteration), so with an iteration budget the result
+// does not depend on the number of threads. A time limit or an early stop at options.target make it
+// depend on how many iterations finished in time.
+Partition GRASP(const Graph & graph, const GRASPOptions & options, GRASPStats * stats = nullptr) {
+    TRACE_SCOPE("GRASP");
+    Stopwatch stopwatch;
+    bool timed = options.time_limit > 0;
+    int iterations = timed ? numeric_limits<int>::max() : options.iterations;
+
+    bool relinking = options.relinking != NO_RELINKING && options.elite_size > 0;
+    ElitePool pool(options.elite_size, (int)(options.elite_min_distance * graph.n));
+    ReactiveAlpha reactive(options.reactive_alphas, options.reactive_amplification);
+    bool reactive_alpha = options.reactive && !options.reactive_alphas.empty();
+    int batch = relinking || reactive_alpha ? options.batch_size : timed ? 4 * options.threads : iterations;
+    batch = max(1, batch);
+
+    Partition best_partition;
+    int best_iteration = -1;
+    GRASPStats local_stats;
+    mutex improvement_mutex;
+    atomic<int> best_cut_weight(numeric_limits<int>::min()); // shared best so far, read without a lock
+
+    auto should_stop = [&]() {
+        return best_cut_weight.load(memory_order_relaxed) >= options.target || (timed && stopwatch.elapsed() >= options.time_limit);
+    };
+
+    for (int batch_start = 0; batch_start < iterations && !should_stop(); batch_start += batch) {
+        int batch_size = min(batch, iterations - batch_start);
+        vector<Partition> results(batch_size);
+        vector<char> finished(batch_size, 0);
+        vector<int> alpha_index(batch_size, -1);
+
+        parallelFor(batch_size, options.threads, [&](int j) {
+            if (should_stop()) return;
+
+            double alpha = options.alpha;
+            if (reactive_alpha) {
+                RandomStream alpha_gen(options.seed, (1ULL << 63) | (batch_start + j)); // apart from the iteration streams
+                alpha_index[j] = reactive.sample(alpha_gen);
+                alpha = reactive.alpha(alpha_index[j]);
+            }
+
+            results[j] = GRASPIteration(graph, options, batch_start + j, alpha, relinking ? &pool : nullptr);
+            finished[j] = 1;
+
+            // Raise the shared best and report the improvement
+            lock_guard<mutex> lock(improvement_mutex);
+            if (results[j].cut_weight > best_cut_weight.load()) {
+                best_cut_weight = results[j].cut_weight;
+                ImprovementEvent event = {stopwatch.elapsed(), results[j].cut_weight, batch_start + j};
+                local_stats.improvements.push_back(event);
+                if (event.cut_weight >= options.target && local_stats.time_to_target < 0) local_stats.time_to_target = event.elapsed;
+                if (options.on_improvement) options.on_improvement(event);
+            }
+        });
+
+        for (int j = 0; j < batch_size; j++) {
+            if (!finished[j]) continue;
+            local_stats.iterations++;
+            if (best_iteration == -1 || results[j].cut_weight > best_partition.cut_weight) {
+                best_partition = results[j];
+                best_iteration = batch_start + j;
+            }
+            if (relinking) pool.insert(results[j]);
+            if (reactive_alpha) reactive.record(alpha_index[j], results[j].cut_weight);
+        }
+        if (reactive_alpha) reactive.updateProbabilities();
+    }
+
+    if (reactive_alpha) reactive.report(local_stats);
+
+    local_stats.elapsed = stopwatch.elapsed();
+    if (stats != nullptr) *stats = local_stats;
     // Return the best partition found
     return best_partition;
-}
\ No newline at end of file
+}
+
+
+struct TimeToTargetStats {
+    int runs = 0;
+    int reached = 0; // runs that found the target within the time limit
+    vector<double> times; // time to target of the runs that reached it
+    double mean = 0, median = 0, p90 = 0;
+};
+
+// Time-to-target statistics over repeated GRASP runs with seeds derived from options.seed.
+// Every run stops at the target or at options.time_limit, which should be set.
+TimeToTargetStats measureTimeToTarget(const Graph & graph, GRASPOptions options, int target, int runs) {
+    TimeToTargetStats result;
+    uint64_t base_seed = options.seed;
+    options.target = target;
+    options.on_improvement = nullptr;
+
+    for (int run = 0; run < runs; run++) {
+        options.seed = mix64(base_seed + run);
+        GRASPStats stats;
+        GRASP(graph, options, &stats);
+
+        result.runs++;
+        if (stats.time_to_target >= 0) {
+            result.reached++;
+            result.times.push_back(stats.time_to_target);
+            result.mean += stats.time_to_target;
+        }
+    }
+
+    if (result.reached > 0) result.mean /= result.reached;
+    result.median = percentile(result.times, 50);
+    result.p90 = percentile(result.times, 90);
+    return result;
+}
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef ANNEALING_HPP
+#define ANNEALING_HPP
+
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <limits>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_random.hpp"
+#include "2105120_parallel.hpp"
+#include "2105120_timing.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+enum CoolingSchedule {
+    GEOMETRIC_COOLING, // T_k = T_0 (T_end / T_0)^(k / (steps - 1))
+    LINEAR_COOLING     // T_k = T_0 + (T_end - T_0) k / (steps - 1)
+};
+
+struct AnnealingOptions {
+    int sweeps = 1000; // temperature steps, each makes n move attempts
+    double initial_temperature = 0; // 0 derives it from the mean |gain| of the start partition
+    double final_temperature = 0; // 0 means a loss of the lightest |weight| is accepted once in 1000 tries
+    CoolingSchedule schedule = GEOMETRIC_COOLING;
+    double time_limit = 0; // seconds, 0 means no time limit
+    uint64_t seed = 0;
+
+    // Parallel tempering
+    int replicas = 8; // replicas at fixed temperatures from final_temperature to initial_temperature
+    int threads = 1;
+    int exchange_interval = 10; // sweeps between replica exchange rounds
+};
+
+
+// One annealing chain. A move flips a random vertex with the O(degree) GainState update and is
+// accepted by the Metropolis rule: always if its gain g >= 0, otherwise with probability e^(g / T).
+// Flips are logged since a base partition and a new best is recorded as a prefix of that log, in O(1).
+// Once the log reaches 4n the best partition is copied out once and the log restarts from the current
+// partition, so memory stays O(n) and the copies cost O(1) per move amortized.
+struct Annealer {
+    const Graph & graph;
+    Partition current;
+    GainState state;
+    RandomStream gen;
+
+    Partition base; // current partition when the trail started
+    vector<int> trail; // flips since base
+    Partition best_partition;
+    size_t best_prefix = 0; // if nonzero the best partition is base plus trail[0 .. best_prefix), not best_partition
+    int best_cut_weight;
+    long long accepted = 0;
+
+    Annealer(const Graph & graph, const Partition & start, RandomStream gen)
+        : graph(graph), current(start), state(graph, current), gen(gen), base(start), best_partition(start), best_cut_weight(start.cut_weight) {}
+
+    // Makes `moves` move attempts at the temperature
+    void anneal(double temperature, long long moves) {
+        int n = graph.n;
+        double inverse_temperature = 1.0 / max(temperature, 1e-300);
+        for (long long move = 0; move < moves; move++) {
+            int v = (int)(gen() % n) + 1;
+            int gain = state.gain[v];
+            if (gain < 0) {
+                double exponent = gain * inverse_temperature;
+                if (exponent < -40) continue; // e^-40 is never drawn
+                if ((gen() >> 11) * 0x1.0p-53 >= exp(exponent)) continue;
+            }
+
+            state.flip(v);
+            trail.push_back(v);
+            accepted++;
+            if (current.cut_weight > best_cut_weight) {
+                best_cut_weight = current.cut_weight;
+                best_prefix = trail.size();
+            }
+            if (trail.size() >= 4 * (size_t)n) compactTrail();
+        }
+    }
+
+    // Copies out the best partition if the trail holds it, then restarts the trail from current
+    void compactTrail() {
+        if (best_prefix > 0) {
+            best_partition = base;
+            for (size_t i = 0; i < best_prefix; i++) best_partition.in_x[trail[i]] ^= 1;
+            best_partition.cut_weight = best_cut_weight;
+        }
+        base = current;
+        trail.clear();
+        best_prefix = 0;
+    }
+
+    Partition best() {
+        compactTrail();
+        return best_partition;
+    }
+};
+
+
+// Default temperature range for a start partition
+pair<double,double> annealingTemperatures(const Graph & graph, const Partition & start, const AnnealingOptions & options) {
+    Partition copy = start;
+    GainState state(graph, copy);
+    double total_gain = 0;
+    int lightest = numeric_limits<int>::max();
+    for (int v = 1; v <= graph.n; v++) total_gain += abs(state.gain[v]);
+    for (auto & edge : graph.edges) {
+        if (edge.weight != 0) lightest = min(lightest, abs(edge.weight));
+    }
+    if (lightest == numeric_limits<int>::max()) lightest = 1;
+
+    // A move losing the mean |gain| is accepted half of the time at the start
+    double initial = options.initial_temperature > 0 ? options.initial_temperature : max(1.0, total_gain / max(1, graph.n)) / log(2.0);
+    double final = options.final_temperature > 0 ? options.final_temperature : lightest / log(1000.0);
+    return {initial, min(initial, final)};
+}
+
+double temperatureAt(int step, int steps, double initial, double final, CoolingSchedule schedule) {
+    double fraction = steps > 1 ? (double)step / (steps - 1) : 1.0;
+    if (schedule == LINEAR_COOLING) return initial + (final - initial) * fraction;
+    return initial * pow(final / initial, fraction);
+}
+
+
+// Simulated annealing from partition over options.sweeps temperature steps of n moves each.
+// Leaves the best partition seen in partition and returns the number of accepted moves.
+long long SimulatedAnnealingMaxCut(const Graph & graph, Partition & partition, const AnnealingOptions & options) {
+    TRACE_SCOPE("SimulatedAnnealingMaxCut");
+    if (graph.n < 2) return 0;
+    Stopwatch stopwatch;
+    auto [initial, final] = annealingTemperatures(graph, partition, options);
+
+    Annealer annealer(graph, partition, RandomStream(options.seed));
+    for (int step = 0; step < options.sweeps; step++) {
+        if (options.time_limit > 0 && stopwatch.elapsed() >= options.time_limit) break;
+        annealer.anneal(temperatureAt(step, options.sweeps, initial, final, options.schedule), graph.n);
+    }
+
+    partition = annealer.best();
+    checkCutWeight(graph, partition);
+    return annealer.accepted;
+}
+
+
+// Parallel tempering: options.replicas chains at fixed temperatures spaced geometrically between the
+// final and the initial temperature, each on its own thread. Every exchange_interval sweeps, the
+// chains at neighboring temperatures i and i + 1 swap temperatures with probability
+// min(1, e^((1 / T_i - 1 / T_i+1) (cut_i+1 - cut_i))), so good partitions drift to the cold end.
+// Each chain keeps its own random stream and the exchanges draw from another one, so the result
+// does not depend on the number of threads. options.sweeps is the number of sweeps of every chain.
+long long ParallelTemperingMaxCut(const Graph & graph, Partition & partition, const AnnealingOptions & options) {
+    TRACE_SCOPE("ParallelTemperingMaxCut");
+    if (graph.n < 2) return 0;
+    Stopwatch stopwatch;
+    int replicas = max(2, options.replicas);
+    auto [initial, final] = annealingTemperatures(graph, partition, options);
+
+    vector<double> temperatures(replicas);
+    for (int k = 0; k < replicas; k++) temperatures[k] = temperatureAt(k, replicas, final, initial, GEOMETRIC_COOLING);
+
+    vector<unique_ptr<Annealer>> chains;
+    for (int k = 0; k < replicas; k++) chains.emplace_back(new Annealer(graph, partition, RandomStream(options.seed, k)));
+    vector<int> chain_at(replicas); // chain running at temperature k
+    iota(chain_at.begin(), chain_at.end(), 0);
+    RandomStream exchange_gen(options.seed, replicas);
+
+    int interval = max(1, options.exchange_interval);
+    for (int sweep = 0; sweep < options.sweeps; sweep += interval) {
+        if (options.time_limit > 0 && stopwatch.elapsed() >= options.time_limit) break;
+        int sweeps = min(interval, options.sweeps - sweep);
+
+        parallelFor(replicas, options.threads, [&](int k) {
+            chains[chain_at[k]]->anneal(temperatures[k], (long long)sweeps * graph.n);
+        });
+
+        // Alternate between the even and the odd neighbor pairs
+        for (int k = (sweep / interval) % 2; k + 1 < replicas; k += 2) {
+            int cold = chains[chain_at[k]]->current.cut_weight, hot = chains[chain_at[k+1]]->current.cut_weight;
+            double exponent = (1 / temperatures[k] - 1 / temperatures[k+1]) * (hot - cold);
+            if (exponent >= 0 || (exchange_gen() >> 11) * 0x1.0p-53 < exp(exponent)) swap(chain_at[k], chain_at[k+1]);
+        }
+    }
+
+    long long accepted = 0;
+    int best_chain = 0;
+    for (int k = 0; k < replicas; k++) {
+        accepted += chains[k]->accepted;
+        if (chains[k]->best_cut_weight > chains[best_chain]->best_cut_weight) best_chain = k;
+    }
+    partition = chains[best_chain]->best();
+    checkCutWeight(graph, partition);
+    return accepted;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include "2105120_timing.hpp"
+
+using namespace std;
+
+// Timed phases of one instance, in results.csv order
+enum BenchmarkPhase { LOAD_PHASE, RANDOMIZED_PHASE, GREEDY_PHASE, SEMI_GREEDY_PHASE, LOCAL_SEARCH_PHASE, GRASP_PHASE, PHASE_COUNT };
+
+const char * const PHASE_NAMES[PHASE_COUNT] = {"load", "randomized", "greedy", "semi_greedy", "local_search", "grasp"};
+
+// Wall times of every phase over the repeated runs of one instance
+struct InstanceBenchmark {
+    string name;
+    int n = 0, m = 0;
+    vector<double> seconds[PHASE_COUNT]; // one sample per run
+
+    double median(int phase) const { return percentile(seconds[phase], 50); }
+};
+
+
+// JSON summary: per instance and phase the median, the 10th and 90th percentiles, min and max in seconds
+void writeBenchmarkJSON(const string & path, const vector<InstanceBenchmark> & instances, uint64_t seed, int repeats) {
+    ofstream json(path);
+    if (!json) throw runtime_error("cannot write " + path);
+
+    json << setprecision(9);
+    json << "{\n  \"seed\": " << seed << ",\n  \"repeats\": " << repeats << ",\n  \"instances\": [\n";
+    for (size_t i = 0; i < instances.size(); i++) {
+        const InstanceBenchmark & instance = instances[i];
+        json << "    {\"name\": \"" << instance.name << "\", \"n\": " << instance.n << ", \"m\": " << instance.m << ", \"phases\": {\n";
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            const vector<double> & samples = instance.seconds[phase];
+            json << "      \"" << PHASE_NAMES[phase] << "\": {\"median\": " << percentile(samples, 50)
+                 << ", \"p10\": " << percentile(samples, 10) << ", \"p90\": " << percentile(samples, 90)
+                 << ", \"min\": " << percentile(samples, 0) << ", \"max\": " << percentile(samples, 100) << "}"
+                 << (phase + 1 < PHASE_COUNT ? "," : "") << "\n";
+        }
+        json << "    }}" << (i + 1 < instances.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+}
+
+
+// Median seconds keyed by (instance, phase) from a summary written by writeBenchmarkJSON. This is not
+// a general JSON parser, it relies on the layout above.
+map<pair<string,string>, double> readBenchmarkMedians(const string & path) {
+    ifstream json(path);
+    if (!json) throw runtime_error("cannot read baseline " + path);
+    stringstream buffer;
+    buffer << json.rdbuf();
+    string text = buffer.str();
+
+    map<pair<string,string>, double> medians;
+    const string name_key = "{\"name\": \"";
+    for (size_t start = text.find(name_key); start != string::npos;) {
+        size_t name_begin = start + name_key.size();
+        string name = text.substr(name_begin, text.find('"', name_begin) - name_begin);
+        size_t end = text.find(name_key, name_begin);
+        if (end == string::npos) end = text.size();
+
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            string phase_key = string("\"") + PHASE_NAMES[phase] + "\": {\"median\": ";
+            size_t position = text.find(phase_key, name_begin);
+            if (position == string::npos || position > end) continue;
+            medians[{name, PHASE_NAMES[phase]}] = stod(text.substr(position + phase_key.size()));
+        }
+        start = end < text.size() ? end : string::npos;
+    }
+    return medians;
+}
+
+
+// Prints every phase whose median got slower than the baseline by more than the relative tolerance
+// (and by more than min_seconds, below which timer noise dominates). Returns the number of regressions.
+int compareWithBaseline(const vector<InstanceBenchmark> & instances, const map<pair<string,string>, double> & baseline,
+                        double tolerance, ostream & out, double min_seconds = 1e-3) {
+    int regressions = 0;
+    out << fixed << setprecision(4);
+    for (auto & instance : instances) {
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            auto it = baseline.find({instance.name, PHASE_NAMES[phase]});
+            if (it == baseline.end()) continue;
+
+            double before = it->second, now = instance.median(phase);
+            if (now > before * (1 + tolerance) && now - before > min_seconds) {
+                regressions++;
+                out << "REGRESSION " << instance.name << " " << PHASE_NAMES[phase] << ": " << before << " s -> " << now
+                    << " s (+" << setprecision(1) << 100 * (now / max(before, 1e-12) - 1) << "%)" << setprecision(4) << "\n";
+            }
+        }
+    }
+    out << defaultfloat;
+    return regressions;
+}
+
+#endif
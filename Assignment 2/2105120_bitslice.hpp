@@ -0,0 +1,113 @@
+#ifndef BITSLICE_HPP
+#define BITSLICE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include "2105120_graph.hpp"
+
+using namespace std;
+
+// Bit-parallel evaluation of many random cuts at once.
+// Partition l of a batch is bit l of every vertex mask, so an edge (u, v) is cut in the partitions
+// mask[u] ^ mask[v]. Per-partition cut weights are kept in bit-sliced counters: bit k of counter l
+// is bit l of plane k, and adding a mask of partitions is a ripple carry over the planes.
+// An edge of weight w adds its mask to one counter per set bit of |w|, one counter set per sign.
+
+const int COUNTER_PLANES = 32; // enough for m < 2^31 additions
+const int WEIGHT_BITS = 32; // bits of |w|, 32 because |INT_MIN| is 2^31
+
+bool cpuSupportsAVX2() {
+    return __builtin_cpu_supports("avx2");
+}
+
+inline void addSliced64(uint64_t * planes, uint64_t mask) {
+    for (int k = 0; mask != 0; k++) {
+        uint64_t carry = planes[k] & mask;
+        planes[k] ^= mask;
+        mask = carry;
+    }
+}
+
+// Cut weights of 64 partitions, the mask of vertex v is masks[stride * v] (1 indexed)
+void evaluateRandomCuts64(const Graph & graph, const uint64_t * masks, long long * cuts, int stride = 1) {
+    vector<uint64_t> planes(2 * WEIGHT_BITS * COUNTER_PLANES, 0);
+    vector<char> used(2 * WEIGHT_BITS, 0);
+
+    for (auto & edge : graph.edges) {
+        uint64_t cut_mask = masks[stride * edge.u] ^ masks[stride * edge.v];
+        if (cut_mask == 0 || edge.weight == 0) continue;
+
+        int sign = edge.weight < 0;
+        uint32_t magnitude = edge.weight < 0 ? -(uint32_t)edge.weight : edge.weight;
+        for (int bit = 0; magnitude != 0; bit++, magnitude >>= 1) {
+            if (!(magnitude & 1)) continue;
+            int counter = sign * WEIGHT_BITS + bit;
+            used[counter] = 1;
+            addSliced64(&planes[counter * COUNTER_PLANES], cut_mask);
+        }
+    }
+
+    memset(cuts, 0, 64 * sizeof(long long));
+    for (int counter = 0; counter < 2 * WEIGHT_BITS; counter++) {
+        if (!used[counter]) continue;
+        bool negative = counter >= WEIGHT_BITS; // shifted as a magnitude, shifting a negative value is undefined
+        for (int k = 0; k < COUNTER_PLANES; k++) {
+            long long value = 1LL << (counter % WEIGHT_BITS + k);
+            if (negative) value = -value;
+            uint64_t plane = planes[counter * COUNTER_PLANES + k];
+            for (; plane != 0; plane &= plane - 1) cuts[__builtin_ctzll(plane)] += value;
+        }
+    }
+}
+
+
+// Same ripple carry on four words, planes holds four words per plane
+__attribute__((target("avx2")))
+inline void addSliced256(uint64_t * planes, __m256i mask) {
+    for (int k = 0; !_mm256_testz_si256(mask, mask); k++) {
+        __m256i * plane = (__m256i *)(planes + 4 * k);
+        __m256i current = _mm256_loadu_si256(plane);
+        _mm256_storeu_si256(plane, _mm256_xor_si256(current, mask));
+        mask = _mm256_and_si256(current, mask);
+    }
+}
+
+// Cut weights of 256 partitions, masks holds four words per vertex (1 indexed)
+__attribute__((target("avx2")))
+void evaluateRandomCuts256(const Graph & graph, const uint64_t * masks, long long * cuts) {
+    vector<uint64_t> planes(4 * 2 * WEIGHT_BITS * COUNTER_PLANES, 0);
+    vector<char> used(2 * WEIGHT_BITS, 0);
+
+    for (auto & edge : graph.edges) {
+        __m256i cut_mask = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(masks + 4 * edge.u)),
+                                            _mm256_loadu_si256((const __m256i *)(masks + 4 * edge.v)));
+        if (_mm256_testz_si256(cut_mask, cut_mask) || edge.weight == 0) continue;
+
+        int sign = edge.weight < 0;
+        uint32_t magnitude = edge.weight < 0 ? -(uint32_t)edge.weight : edge.weight;
+        for (int bit = 0; magnitude != 0; bit++, magnitude >>= 1) {
+            if (!(magnitude & 1)) continue;
+            int counter = sign * WEIGHT_BITS + bit;
+            used[counter] = 1;
+            addSliced256(&planes[4 * counter * COUNTER_PLANES], cut_mask);
+        }
+    }
+
+    memset(cuts, 0, 256 * sizeof(long long));
+    for (int counter = 0; counter < 2 * WEIGHT_BITS; counter++) {
+        if (!used[counter]) continue;
+        bool negative = counter >= WEIGHT_BITS; // shifted as a magnitude, shifting a negative value is undefined
+        for (int k = 0; k < COUNTER_PLANES; k++) {
+            long long value = 1LL << (counter % WEIGHT_BITS + k);
+            if (negative) value = -value;
+            const uint64_t * words = &planes[4 * (counter * COUNTER_PLANES + k)];
+            for (int word = 0; word < 4; word++) {
+                for (uint64_t plane = words[word]; plane != 0; plane &= plane - 1) cuts[64 * word + __builtin_ctzll(plane)] += value;
+            }
+        }
+    }
+}
+
+#endif
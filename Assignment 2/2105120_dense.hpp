@@ -0,0 +1,190 @@
+#ifndef DENSE_HPP
+#define DENSE_HPP
+
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <immintrin.h>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_bitslice.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+// Dense storage for dense graphs. Row v of the weight matrix is a contiguous, 32 byte aligned int32
+// array indexed by vertex (column 0 and the padding up to the stride are zero), so the updates that
+// touch every neighbor of a vertex become whole-row vector operations instead of scattered adjacency
+// list walks. Rows are processed 8 ints at a time with AVX2 when the CPU has it, scalar otherwise.
+
+// Zero filled int32 buffer of a multiple of 8 elements, aligned for 256 bit loads
+class AlignedInts {
+    unique_ptr<int, void (*)(void *)> data_;
+    size_t size_;
+
+public:
+    AlignedInts(size_t size = 0) : data_(nullptr, free), size_((size + 7) / 8 * 8) {
+        if (size_ == 0) return;
+        data_.reset(static_cast<int *>(aligned_alloc(32, size_ * sizeof(int))));
+        if (!data_) throw bad_alloc();
+        memset(data_.get(), 0, size_ * sizeof(int));
+    }
+
+    int * data() { return data_.get(); }
+    const int * data() const { return data_.get(); }
+    int & operator[](size_t i) { return data_.get()[i]; }
+    int operator[](size_t i) const { return data_.get()[i]; }
+    size_t size() const { return size_; }
+};
+
+
+struct DenseMatrix {
+    int n = 0;
+    size_t stride = 0; // ints per row, n + 1 rounded up to a multiple of 8
+    AlignedInts weights;
+
+    const int * row(int v) const { return weights.data() + v * stride; }
+};
+
+// Parallel edges add up, self loops are dropped
+DenseMatrix buildDenseMatrix(const Graph & graph) {
+    DenseMatrix matrix;
+    matrix.n = graph.n;
+    matrix.stride = (graph.n + 1 + 7) / 8 * 8;
+    matrix.weights = AlignedInts((graph.n + 1) * matrix.stride);
+    for (auto & edge : graph.edges) {
+        if (edge.u == edge.v) continue;
+        matrix.weights[edge.u * matrix.stride + edge.v] += edge.weight;
+        matrix.weights[edge.v * matrix.stride + edge.u] += edge.weight;
+    }
+    return matrix;
+}
+
+// Fraction of the vertex pairs that are edges
+double edgeDensity(const Graph & graph) {
+    return graph.n > 1 ? 2.0 * graph.m / ((double)graph.n * (graph.n - 1)) : 0.0;
+}
+
+
+// Row kernels over count ints (a multiple of 8, all pointers 32 byte aligned)
+
+// target += row
+void addRowScalar(int * target, const int * row, size_t count) {
+    for (size_t i = 0; i < count; i++) target[i] += row[i];
+}
+
+__attribute__((target("avx2")))
+void addRowAVX2(int * target, const int * row, size_t count) {
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i sum = _mm256_add_epi32(_mm256_load_si256((const __m256i *)(target + i)), _mm256_load_si256((const __m256i *)(row + i)));
+        _mm256_store_si256((__m256i *)(target + i), sum);
+    }
+}
+
+// target += 2 * factor * row * sign elementwise, with factor and every sign in {-1, 1}
+void addSignedRowScalar(int * target, const int * row, const int * sign, int factor, size_t count) {
+    for (size_t i = 0; i < count; i++) target[i] += 2 * factor * row[i] * sign[i];
+}
+
+__attribute__((target("avx2")))
+void addSignedRowAVX2(int * target, const int * row, const int * sign, int factor, size_t count) {
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i signed_row = _mm256_sign_epi32(_mm256_load_si256((const __m256i *)(row + i)), _mm256_load_si256((const __m256i *)(sign + i)));
+        signed_row = _mm256_slli_epi32(signed_row, 1);
+        __m256i current = _mm256_load_si256((const __m256i *)(target + i));
+        current = factor > 0 ? _mm256_add_epi32(current, signed_row) : _mm256_sub_epi32(current, signed_row);
+        _mm256_store_si256((__m256i *)(target + i), current);
+    }
+}
+
+// sum of row * sign elementwise
+long long signedDotScalar(const int * row, const int * sign, size_t count) {
+    long long sum = 0;
+    for (size_t i = 0; i < count; i++) sum += row[i] * sign[i];
+    return sum;
+}
+
+__attribute__((target("avx2")))
+long long signedDotAVX2(const int * row, const int * sign, size_t count) {
+    __m256i sum = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i signed_row = _mm256_sign_epi32(_mm256_load_si256((const __m256i *)(row + i)), _mm256_load_si256((const __m256i *)(sign + i)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(signed_row)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(signed_row, 1)));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256((__m256i *)lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+
+// Incremental construction on a dense matrix, like ConstructionState: placing v adds its row to the
+// side sums of its side
+struct DenseConstructionState {
+    const DenseMatrix & matrix;
+    AlignedInts sigma_x, sigma_y;
+    vector<char> placed; // 0 for unassigned, 'x' or 'y' otherwise, 1 indexed
+    int cut_weight = 0;
+    bool avx2;
+
+    DenseConstructionState(const DenseMatrix & matrix)
+        : matrix(matrix), sigma_x(matrix.stride), sigma_y(matrix.stride), placed(matrix.n + 1, 0), avx2(cpuSupportsAVX2()) {}
+
+    void place(int v, char side) {
+        TRACE_COUNT(TRACE_CONSTRUCTION_STEPS, 1);
+        placed[v] = side;
+        cut_weight += side == 'x' ? sigma_y[v] : sigma_x[v];
+        int * sigma = side == 'x' ? sigma_x.data() : sigma_y.data();
+        if (avx2) addRowAVX2(sigma, matrix.row(v), matrix.stride);
+        else addRowScalar(sigma, matrix.row(v), matrix.stride);
+    }
+
+    char bestSide(int v) const {
+        return sigma_y[v] > sigma_x[v] ? 'x' : 'y';
+    }
+
+    Partition partition() const {
+        Partition partition;
+        partition.in_x.assign(matrix.n + 1, 0);
+        for (int v = 1; v <= matrix.n; v++) partition.in_x[v] = placed[v] == 'x';
+        partition.cut_weight = cut_weight;
+        return partition;
+    }
+};
+
+
+// Flip gains on a dense matrix, the same values as GainState. With s[u] = +1 for x and -1 for y,
+// gain[v] = s[v] * sum_u w[v][u] s[u], and flipping v adds 2 s[v] w[v][u] s[u] to every gain[u]
+// (s[v] taken after the flip), one signed row update.
+struct DenseGainState {
+    const DenseMatrix & matrix;
+    Partition & partition;
+    AlignedInts gain, sign;
+    bool avx2;
+
+    DenseGainState(const DenseMatrix & matrix, Partition & partition)
+        : matrix(matrix), partition(partition), gain(matrix.stride), sign(matrix.stride), avx2(cpuSupportsAVX2()) {
+        TRACE_COUNT(TRACE_GAIN_UPDATES, matrix.n);
+        for (int v = 1; v <= matrix.n; v++) sign[v] = partition.in_x[v] ? 1 : -1;
+        for (int v = 1; v <= matrix.n; v++) {
+            long long dot = avx2 ? signedDotAVX2(matrix.row(v), sign.data(), matrix.stride) : signedDotScalar(matrix.row(v), sign.data(), matrix.stride);
+            gain[v] = sign[v] * (int)dot;
+        }
+    }
+
+    void flip(int v) {
+        TRACE_COUNT(TRACE_FLIPS, 1);
+        TRACE_COUNT(TRACE_GAIN_UPDATES, matrix.n);
+        partition.in_x[v] ^= 1;
+        partition.cut_weight += gain[v];
+        gain[v] = -gain[v];
+        sign[v] = -sign[v];
+        // w[v][v] is zero, so gain[v] is left alone
+        if (avx2) addSignedRowAVX2(gain.data(), matrix.row(v), sign.data(), sign[v], matrix.stride);
+        else addSignedRowScalar(gain.data(), matrix.row(v), sign.data(), sign[v], matrix.stride);
+    }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <cstdio>
+#include <climits>
+#include <charconv>
+#include "2105120_generator.hpp"
+#include "2105120_loader.hpp"
+
+using namespace std;
+
+
+// Buffered .rud writer, integers are formatted with to_chars instead of going through a stream
+class RudWriter {
+    FILE * out;
+    vector<char> buffer;
+    size_t used = 0;
+
+    void flush() {
+        if (used > 0 && fwrite(buffer.data(), 1, used, out) != used) throw runtime_error("failed to write .rud file");
+        used = 0;
+    }
+
+public:
+    RudWriter(const string & path) : out(fopen(path.c_str(), "wb")), buffer(1 << 20) {
+        if (out == nullptr) throw runtime_error("cannot write " + path);
+    }
+
+    ~RudWriter() {
+        if (out != nullptr) fclose(out);
+    }
+
+    void line(long long a, long long b, long long c, bool three = true) {
+        if (buffer.size() - used < 64) flush();
+        char * position = buffer.data() + used;
+        char * end = buffer.data() + buffer.size();
+        position = to_chars(position, end, a).ptr;
+        *position++ = ' ';
+        position = to_chars(position, end, b).ptr;
+        if (three) {
+            *position++ = ' ';
+            position = to_chars(position, end, c).ptr;
+        }
+        *position++ = '\n';
+        used = position - buffer.data();
+    }
+
+    void close() {
+        flush();
+        if (fclose(out) != 0) throw runtime_error("failed to write .rud file");
+        out = nullptr;
+    }
+};
+
+
+int main(int argc, char *argv[]) {
+    // Usage: generator FAMILY OUTPUT [--n=N] [--density=P] [--edges=M] [--rows=R] [--cols=C]
+    //                  [--weights=unit|pm1] [--seed=N] [--binary]
+    // FAMILY is random (G(n, p), density p or an expected number of edges M), toroidal (rows x cols,
+    // or a near square torus of about n vertices) or planar (n vertices, or rows x cols).
+    // --binary writes the binary graph format instead of .rud, loadGraph reads both.
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " random|toroidal|planar OUTPUT [--n=N] [--density=P] [--edges=M] [--rows=R] [--cols=C]"
+             << " [--weights=unit|pm1] [--seed=N] [--binary]" << endl;
+        return 1;
+    }
+
+    string family = argv[1];
+    string output_file = argv[2];
+    long long n = 0, edges = 0;
+    int rows = 0, cols = 0;
+    double density = -1;
+    EdgeWeights weights = UNIT_WEIGHTS;
+    uint64_t seed = 0;
+    bool binary = false;
+
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--n=", 0) == 0) n = stoll(arg.substr(4));
+        else if (arg.rfind("--density=", 0) == 0) density = stod(arg.substr(10));
+        else if (arg.rfind("--edges=", 0) == 0) edges = stoll(arg.substr(8));
+        else if (arg.rfind("--rows=", 0) == 0) rows = stoi(arg.substr(7));
+        else if (arg.rfind("--cols=", 0) == 0) cols = stoi(arg.substr(7));
+        else if (arg == "--weights=unit") weights = UNIT_WEIGHTS;
+        else if (arg == "--weights=pm1") weights = PLUS_MINUS_ONE;
+        else if (arg.rfind("--seed=", 0) == 0) seed = stoull(arg.substr(7));
+        else if (arg == "--binary") binary = true;
+        else {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    // Grid shape from n when rows and cols are not given, a planar graph keeps exactly n vertices
+    if (family != "random" && (rows <= 0 || cols <= 0)) {
+        rows = max(1, (int)sqrt((double)n));
+        cols = (int)((n + rows - 1) / rows);
+    }
+    if (family == "toroidal" || (family == "planar" && n <= 0)) n = (long long)rows * cols;
+
+    if (family == "random") {
+        if (density < 0 && edges > 0 && n > 1) density = min(1.0, edges / (n * (n - 1) / 2.0));
+        if (density < 0) density = 0.06; // like G1
+    } else if (density < 0) {
+        density = 1;
+    }
+    if (n < 1 || n > INT_MAX) {
+        cerr << "The number of vertices must be between 1 and " << INT_MAX << endl;
+        return 1;
+    }
+
+    auto generate = [&](auto emit) {
+        if (family == "random") generateRandomGraph((int)n, density, weights, seed, emit);
+        else if (family == "toroidal") generateToroidalGrid(rows, cols, weights, seed, emit);
+        else if (family == "planar") generatePlanarGraph((int)n, max(1, cols), density, weights, seed, emit);
+        else throw invalid_argument("unknown graph family " + family);
+    };
+
+    long long m = 0;
+    try {
+        if (binary) {
+            // The binary header is written last, so one pass is enough
+            BinaryGraphWriter writer(output_file);
+            generate([&](int u, int v, int weight) {
+                writer.add({u, v, weight});
+                m++;
+            });
+            if (m > INT_MAX) throw runtime_error("too many edges for the graph loader");
+            writer.finish((int)n);
+        } else {
+            // .rud starts with m, so a first pass counts the edges and a second one with the same seed writes them
+            generate([&](int, int, int) { m++; });
+            if (m > INT_MAX) throw runtime_error("too many edges for the graph loader");
+
+            RudWriter writer(output_file);
+            writer.line(n, m, 0, false);
+            generate([&](int u, int v, int weight) { writer.line(u, v, weight); });
+            writer.close();
+        }
+    } catch (const exception & error) {
+        cerr << error.what() << endl;
+        return 1;
+    }
+
+    cout << family << " graph with " << n << " vertices and " << m << " edges written to " << output_file << endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include "2105120_random.hpp"
+
+using namespace std;
+
+// Synthetic G-set style graphs. Every generator calls emit(u, v, weight) once per edge (1 indexed,
+// u < v, no duplicates) in a fixed order and keeps no per-edge state, so memory stays constant and
+// running it twice with the same seed emits the same edges.
+
+enum EdgeWeights {
+    UNIT_WEIGHTS,      // every edge has weight 1
+    PLUS_MINUS_ONE     // +1 or -1 with equal probability
+};
+
+int drawWeight(EdgeWeights weights, RandomStream & gen) {
+    return weights == UNIT_WEIGHTS || (gen() & 1) ? 1 : -1;
+}
+
+
+// Erdos-Renyi G(n, p): every pair is an edge with probability density. The gap to the next edge in
+// the row-major order of the pairs is geometric, so the generator skips over the absent pairs and
+// takes O(n + m) time instead of O(n^2) (Batagelj and Brandes).
+template <typename Emit>
+void generateRandomGraph(int n, double density, EdgeWeights weights, uint64_t seed, Emit emit) {
+    if (density <= 0 || n < 2) return;
+    RandomStream gen(seed);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    double log_absent = density < 1 ? log(1 - density) : 0;
+
+    // Pair (w, v) with 0 <= w < v < n, 0 indexed
+    long long v = 1, w = -1;
+    while (v < n) {
+        double skip = density < 1 ? floor(log(1 - uniform(gen)) / log_absent) : 0;
+        w += 1 + (long long)min(skip, (double)n * n);
+        while (w >= v && v < n) {
+            w -= v;
+            v++;
+        }
+        if (v < n) emit((int)w + 1, (int)v + 1, drawWeight(weights, gen));
+    }
+}
+
+
+// rows x cols torus, every vertex joined to its right and lower neighbors with wrap-around
+template <typename Emit>
+void generateToroidalGrid(int rows, int cols, EdgeWeights weights, uint64_t seed, Emit emit) {
+    if (rows < 3 || cols < 3) throw invalid_argument("a toroidal grid needs at least 3 rows and 3 columns");
+    RandomStream gen(seed);
+    auto id = [&](int r, int c) { return r * cols + c + 1; };
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int v = id(r, c), right = id(r, (c + 1) % cols), down = id((r + 1) % rows, c);
+            emit(min(v, right), max(v, right), drawWeight(weights, gen));
+            emit(min(v, down), max(v, down), drawWeight(weights, gen));
+        }
+    }
+}
+
+
+// Planar graph: a grid with cols columns filled row by row with n vertices, where every cell gets one
+// of its two diagonals at random, a triangulation with average degree close to 6. Every edge is kept
+// with probability density, and a subgraph of a planar graph stays planar.
+template <typename Emit>
+void generatePlanarGraph(int n, int cols, double density, EdgeWeights weights, uint64_t seed, Emit emit) {
+    RandomStream gen(seed);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    int rows = (n + cols - 1) / cols;
+    auto id = [&](int r, int c) { return r * cols + c + 1; };
+    auto maybeEmit = [&](int u, int v) {
+        if (u > n || v > n) return; // the last row may be partial
+        bool keep = density >= 1 || uniform(gen) < density;
+        int weight = drawWeight(weights, gen);
+        if (keep) emit(min(u, v), max(u, v), weight);
+    };
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (c + 1 < cols) maybeEmit(id(r, c), id(r, c + 1));
+            if (r + 1 < rows) maybeEmit(id(r, c), id(r + 1, c));
+            if (r + 1 < rows && c + 1 < cols) {
+                if (gen() & 1) maybeEmit(id(r, c), id(r + 1, c + 1));
+                else maybeEmit(id(r, c + 1), id(r + 1, c));
+            }
+        }
+    }
+}
+
+#endif
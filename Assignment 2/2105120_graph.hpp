@@ -0,0 +1,52 @@
+#ifndef GRAPH_HPP
+#define GRAPH_HPP
+
+#include <vector>
+
+using namespace std;
+
+struct Edge {
+    int u, v, weight;
+};
+
+// Undirected weighted graph, vertices are 1 indexed.
+// The neighbors of v are neighbor[offset[v]] .. neighbor[offset[v+1] - 1] (compressed sparse rows).
+struct Graph {
+    int n = 0, m = 0;
+    vector<Edge> edges;
+    vector<int> offset;
+    vector<int> neighbor;
+    vector<int> neighbor_weight;
+
+    int degree(int v) const { return offset[v+1] - offset[v]; }
+};
+
+
+Graph buildGraph(int n, vector<Edge> edges) {
+    Graph graph;
+    graph.n = n;
+    graph.m = edges.size();
+    graph.edges = move(edges);
+    graph.offset.assign(n + 2, 0);
+
+    for (auto & edge : graph.edges) {
+        graph.offset[edge.u + 1]++;
+        graph.offset[edge.v + 1]++;
+    }
+    for (int v = 1; v <= n + 1; v++) graph.offset[v] += graph.offset[v-1];
+
+    graph.neighbor.resize(2 * graph.m);
+    graph.neighbor_weight.resize(2 * graph.m);
+    vector<int> next(graph.offset.begin(), graph.offset.end() - 1);
+
+    for (auto & edge : graph.edges) {
+        graph.neighbor[next[edge.u]] = edge.v;
+        graph.neighbor_weight[next[edge.u]++] = edge.weight;
+        graph.neighbor[next[edge.v]] = edge.u;
+        graph.neighbor_weight[next[edge.v]++] = edge.weight;
+    }
+
+    return graph;
+}
+
+#endif
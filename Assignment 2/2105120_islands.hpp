@@ -0,0 +1,214 @@
+#ifndef ISLANDS_HPP
+#define ISLANDS_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_algorithms.hpp"
+
+using namespace std;
+
+// Island-model GRASP on worker processes.
+// The coordinator forks one process per island after the graph is loaded, so every island reads the
+// same physical copy of the graph (the pages are shared copy-on-write and never written) and a crash
+// or a leak stays inside one island. Islands form a ring: every migration interval an island
+// publishes its best partition to its outbox and takes the partitions its predecessor published into
+// its elite pool, where path relinking uses them as guides. At the end every island writes its best
+// partition to its result slot and the coordinator keeps the best one.
+//
+// An outbox is a broadcast ring of slots in shared memory with one writer and lock-free readers.
+// Every slot carries a sequence number (a seqlock): odd while the writer fills it, 2t + 2 once it
+// holds publication t. A reader copies the slot and accepts the copy only if the sequence number
+// was 2t + 2 before and after, otherwise the writer has lapped it and the migrant is skipped.
+
+static_assert(atomic<uint64_t>::is_always_lock_free, "the shared memory rings need lock-free 64 bit atomics");
+
+struct IslandOptions {
+    int islands = 4; // worker processes
+    int migration_interval = 10; // iterations between migrations
+    int ring_capacity = 4; // slots per outbox
+};
+
+struct IslandStats {
+    int iterations = 0; // over all islands
+    vector<int> island_cut_weights; // best cut of every island, INT_MIN for an island that failed
+    long long migrants_received = 0;
+    long long migrants_accepted = 0; // migrants that entered an elite pool
+};
+
+
+// Shared memory layout, every block starts on a 64 byte boundary: per island an outbox (publication
+// counter, then ring_capacity slots), then per island a result slot, then per island its migration
+// counters. A slot is a sequence number, a cut weight and the n + 1 bytes of in_x.
+class IslandSharedMemory {
+    int islands, capacity, n;
+    size_t slot_size, outbox_size;
+    size_t size_;
+    char * base;
+
+    static size_t roundUp(size_t bytes) { return (bytes + 63) / 64 * 64; }
+
+public:
+    IslandSharedMemory(int islands, int capacity, int n) : islands(islands), capacity(capacity), n(n) {
+        slot_size = roundUp(sizeof(atomic<uint64_t>) + sizeof(int) + n + 1);
+        outbox_size = 64 + capacity * slot_size;
+        size_ = islands * (outbox_size + slot_size + 64);
+        void * mapped = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) throw runtime_error("cannot map the island shared memory");
+        base = static_cast<char *>(mapped); // zero filled
+    }
+
+    ~IslandSharedMemory() { munmap(base, size_); }
+
+    IslandSharedMemory(const IslandSharedMemory &) = delete;
+    IslandSharedMemory & operator=(const IslandSharedMemory &) = delete;
+
+    atomic<uint64_t> & published(int island) { return *reinterpret_cast<atomic<uint64_t> *>(base + island * outbox_size); }
+    char * outboxSlot(int island, uint64_t ticket) { return base + island * outbox_size + 64 + (ticket % capacity) * slot_size; }
+    char * resultSlot(int island) { return base + islands * outbox_size + island * slot_size; }
+    // Iterations, migrants received and migrants accepted by island
+    long long * counters(int island) { return reinterpret_cast<long long *>(base + islands * (outbox_size + slot_size) + island * 64); }
+
+    static atomic<uint64_t> & sequence(char * slot) { return *reinterpret_cast<atomic<uint64_t> *>(slot); }
+    static int * cutWeight(char * slot) { return reinterpret_cast<int *>(slot + sizeof(atomic<uint64_t>)); }
+    static char * sides(char * slot) { return slot + sizeof(atomic<uint64_t>) + sizeof(int); }
+
+    // Writer side of the outbox of island
+    void publish(int island, const Partition & partition) {
+        uint64_t ticket = published(island).load(memory_order_relaxed);
+        char * slot = outboxSlot(island, ticket);
+        sequence(slot).store(2 * ticket + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        *cutWeight(slot) = partition.cut_weight;
+        memcpy(sides(slot), partition.in_x.data(), n + 1);
+        sequence(slot).store(2 * ticket + 2, memory_order_release);
+        published(island).store(ticket + 1, memory_order_release);
+    }
+
+    // Reads publication ticket of island, returns false if it was overwritten meanwhile
+    bool read(int island, uint64_t ticket, Partition & partition) {
+        char * slot = outboxSlot(island, ticket);
+        if (sequence(slot).load(memory_order_acquire) != 2 * ticket + 2) return false;
+        partition.in_x.resize(n + 1);
+        partition.cut_weight = *cutWeight(slot);
+        memcpy(partition.in_x.data(), sides(slot), n + 1);
+        atomic_thread_fence(memory_order_acquire);
+        return sequence(slot).load(memory_order_relaxed) == 2 * ticket + 2;
+    }
+};
+
+
+// The work of one island process
+Partition runIsland(const Graph & graph, GRASPOptions options, const IslandOptions & island_options, int island, IslandSharedMemory & shared) {
+    long long & received = shared.counters(island)[0];
+    long long & accepted = shared.counters(island)[1];
+    long long & iterations_done = shared.counters(island)[2];
+    options.seed = mix64(options.seed + island);
+    int source = (island + island_options.islands - 1) % island_options.islands;
+    uint64_t next_ticket = 0; // next publication of the source to read
+
+    Stopwatch stopwatch;
+    bool relinking = options.relinking != NO_RELINKING && options.elite_size > 0;
+    ElitePool pool(options.elite_size, (int)(options.elite_min_distance * graph.n));
+    Partition best;
+    best.cut_weight = numeric_limits<int>::min();
+
+    // Like GRASP, a time limit replaces the iteration budget
+    int iterations = options.time_limit > 0 ? numeric_limits<int>::max() : options.iterations;
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        if (options.time_limit > 0 && stopwatch.elapsed() >= options.time_limit) break;
+
+        Partition partition = GRASPIteration(graph, options, iteration, options.alpha, relinking ? &pool : nullptr);
+        iterations_done++;
+        if (partition.cut_weight > best.cut_weight) best = partition;
+        if (relinking) pool.insert(partition);
+
+        if (island_options.islands == 1 || (iteration + 1) % island_options.migration_interval != 0) continue;
+        shared.publish(island, best);
+
+        // Publications older than the ring capacity are gone, skip to the oldest one still there
+        uint64_t published = shared.published(source).load(memory_order_acquire);
+        if (published > next_ticket + island_options.ring_capacity) next_ticket = published - island_options.ring_capacity;
+        Partition migrant;
+        for (; next_ticket < published; next_ticket++) {
+            if (!shared.read(source, next_ticket, migrant)) continue;
+            received++;
+            if (relinking && pool.insert(migrant)) accepted++;
+            if (migrant.cut_weight > best.cut_weight) best = migrant;
+        }
+    }
+    return best;
+}
+
+
+// Coordinator: forks the islands, waits for all of them and returns the best partition.
+// Island i uses the seed mix64(options.seed + i) and options.iterations iterations (or the time limit).
+Partition IslandGRASP(const Graph & graph, const GRASPOptions & options, const IslandOptions & island_options, IslandStats * stats = nullptr) {
+    int islands = max(1, island_options.islands);
+    IslandOptions normalized = island_options;
+    normalized.islands = islands;
+    normalized.migration_interval = max(1, island_options.migration_interval);
+    normalized.ring_capacity = max(1, island_options.ring_capacity);
+
+    IslandSharedMemory shared(islands, normalized.ring_capacity, graph.n);
+
+    GRASPOptions island_grasp = options;
+    island_grasp.on_improvement = nullptr; // would run in another process
+    island_grasp.threads = 1;
+
+    vector<pid_t> workers;
+    for (int island = 0; island < islands; island++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            for (pid_t worker : workers) waitpid(worker, nullptr, 0);
+            throw runtime_error("cannot fork island worker");
+        }
+        if (pid == 0) {
+            int status = 0;
+            try {
+                Partition best = runIsland(graph, island_grasp, normalized, island, shared);
+                char * slot = shared.resultSlot(island);
+                *IslandSharedMemory::cutWeight(slot) = best.cut_weight;
+                memcpy(IslandSharedMemory::sides(slot), best.in_x.data(), graph.n + 1);
+                IslandSharedMemory::sequence(slot).store(1, memory_order_release);
+            } catch (...) {
+                status = 1;
+            }
+            _exit(status); // no destructors or stdio flushes of the coordinator's state
+        }
+        workers.push_back(pid);
+    }
+
+    IslandStats local_stats;
+    Partition best;
+    best.cut_weight = numeric_limits<int>::min();
+    for (int island = 0; island < islands; island++) {
+        int status = 0;
+        waitpid(workers[island], &status, 0);
+        char * slot = shared.resultSlot(island);
+        bool finished = WIFEXITED(status) && WEXITSTATUS(status) == 0 && IslandSharedMemory::sequence(slot).load(memory_order_acquire) == 1;
+
+        int cut_weight = finished ? *IslandSharedMemory::cutWeight(slot) : numeric_limits<int>::min();
+        local_stats.island_cut_weights.push_back(cut_weight);
+        local_stats.migrants_received += shared.counters(island)[0];
+        local_stats.migrants_accepted += shared.counters(island)[1];
+        local_stats.iterations += shared.counters(island)[2];
+        if (finished && cut_weight > best.cut_weight) {
+            best.cut_weight = cut_weight;
+            best.in_x.assign(IslandSharedMemory::sides(slot), IslandSharedMemory::sides(slot) + graph.n + 1);
+        }
+    }
+    if (best.in_x.empty()) throw runtime_error("every island worker failed");
+    checkCutWeight(graph, best);
+    if (stats != nullptr) *stats = local_stats;
+    return best;
+}
+
+#endif
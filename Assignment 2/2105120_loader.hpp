@@ -0,0 +1,311 @@
+#ifndef LOADER_HPP
+#define LOADER_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "2105120_graph.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+    int fd = -1;
+    const char * data_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    MappedFile(const string & path) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("cannot open " + path);
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw runtime_error("cannot stat " + path);
+        }
+        size_ = info.st_size;
+        if (size_ == 0) return;
+
+        void * mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("cannot map " + path);
+        }
+        madvise(mapped, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(mapped);
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr) munmap(const_cast<char *>(data_), size_);
+        if (fd >= 0) close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    const char * data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+
+// Integer scanner over a memory buffer, replaces istream >> for the .rud edge lists
+class IntScanner {
+    const char * current;
+    const char * end;
+
+public:
+    IntScanner(const char * begin, size_t size) : current(begin), end(begin + size) {}
+
+    bool next(long long & value) {
+        while (current < end && (*current == ' ' || *current == '\n' || *current == '\r' || *current == '\t')) current++;
+        if (current == end) return false;
+
+        bool negative = false;
+        if (*current == '-' || *current == '+') negative = *current++ == '-';
+        if (current == end || *current < '0' || *current > '9') throw runtime_error("malformed integer in graph file");
+
+        long long result = 0;
+        while (current < end && *current >= '0' && *current <= '9') {
+            int digit = *current++ - '0';
+            result = result > (1LL << 40) ? result : result * 10 + digit; // saturates far outside the int range
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    int nextInt() {
+        long long value;
+        if (!next(value)) throw runtime_error("unexpected end of graph file");
+        if (value < INT_MIN || value > INT_MAX) throw runtime_error("integer out of range in graph file");
+        return (int)value;
+    }
+};
+
+
+// Replaces parallel edges by one edge with their total weight, at the place of the first of them.
+// The gain formulas (GainState, the 2-flip move of VND) assume a simple graph. O(n + m).
+void mergeParallelEdges(int n, vector<Edge> & edges) {
+    int m = edges.size();
+    vector<int> start(n + 2, 0), by_lower(m); // edge indices grouped by lower endpoint, in input order
+    for (auto & edge : edges) start[min(edge.u, edge.v) + 1]++;
+    for (int v = 1; v <= n + 1; v++) start[v] += start[v-1];
+    vector<int> next(start.begin(), start.end() - 1);
+    for (int e = 0; e < m; e++) by_lower[next[min(edges[e].u, edges[e].v)]++] = e;
+
+    vector<int> seen_from(n + 1, 0), first_edge(n + 1); // first edge from the current lower endpoint to v
+    vector<long long> weight;
+    vector<char> merged;
+    for (int a = 1; a <= n; a++) {
+        for (int i = start[a]; i < start[a+1]; i++) {
+            int e = by_lower[i], b = max(edges[e].u, edges[e].v);
+            if (seen_from[b] != a) {
+                seen_from[b] = a;
+                first_edge[b] = e;
+                continue;
+            }
+            if (merged.empty()) { // first parallel edge, most graphs never get here
+                merged.assign(m, 0);
+                weight.resize(m);
+                for (int f = 0; f < m; f++) weight[f] = edges[f].weight;
+            }
+            weight[first_edge[b]] += edges[e].weight;
+            merged[e] = 1;
+        }
+    }
+    if (merged.empty()) return;
+
+    int kept = 0;
+    for (int e = 0; e < m; e++) {
+        if (merged[e]) continue;
+        if (weight[e] < INT_MIN || weight[e] > INT_MAX) throw runtime_error("parallel edges add up to a weight out of the int range");
+        edges[kept] = edges[e];
+        edges[kept++].weight = (int)weight[e];
+    }
+    edges.resize(kept);
+}
+
+
+// Reads a graph in .rud format: "n m" followed by m lines "u v w"
+Graph loadRudGraph(const string & path) {
+    MappedFile file(path);
+    IntScanner scanner(file.data(), file.size());
+
+    int n = scanner.nextInt();
+    int m = scanner.nextInt();
+    if (n < 0 || m < 0) throw runtime_error("invalid graph size in " + path);
+
+    vector<Edge> edges(m);
+    for (auto & edge : edges) {
+        edge.u = scanner.nextInt();
+        edge.v = scanner.nextInt();
+        edge.weight = scanner.nextInt();
+        if (edge.u < 1 || edge.u > n || edge.v < 1 || edge.v > n) throw runtime_error("vertex out of range in " + path);
+        if (edge.u == edge.v) throw runtime_error("self-loop in " + path); // the gain updates assume a simple graph
+    }
+    mergeParallelEdges(n, edges);
+    return buildGraph(n, move(edges));
+}
+
+
+
+// Binary graph format, used as a cache of parsed .rud files and as generator output:
+// a BinaryGraphHeader followed by m (u, v, weight) int32 triples.
+const char BINARY_GRAPH_MAGIC[8] = {'M', 'C', 'G', 'R', 'A', 'P', 'H', '\0'};
+const uint32_t BINARY_GRAPH_VERSION = 1;
+static_assert(sizeof(Edge) == 3 * sizeof(int32_t), "edges are stored as packed int32 triples");
+
+struct BinaryGraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    int64_t n, m;
+    uint64_t checksum; // of the edge records
+    int64_t source_size; // size and modification time in nanoseconds of the .rud file a cache was made from,
+    int64_t source_mtime; // 0 otherwise
+};
+
+uint64_t updateEdgeChecksum(uint64_t checksum, const Edge & edge) {
+    const uint64_t prime = 0x100000001B3ULL;
+    checksum = (checksum ^ ((uint64_t)(uint32_t)edge.u << 32 | (uint32_t)edge.v)) * prime;
+    checksum = (checksum ^ (uint32_t)edge.weight) * prime;
+    return checksum;
+}
+
+const uint64_t EDGE_CHECKSUM_SEED = 0xCBF29CE484222325ULL;
+
+
+// Streams edges into a binary graph file, the header is written last so m need not be known upfront
+class BinaryGraphWriter {
+    ofstream out;
+    BinaryGraphHeader header;
+
+public:
+    BinaryGraphWriter(const string & path) : out(path, ios::binary | ios::trunc) {
+        if (!out) throw runtime_error("cannot write " + path);
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic));
+        header.version = BINARY_GRAPH_VERSION;
+        header.header_size = sizeof(BinaryGraphHeader);
+        header.checksum = EDGE_CHECKSUM_SEED;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    void add(const Edge & edge) {
+        out.write(reinterpret_cast<const char *>(&edge), sizeof(Edge));
+        header.checksum = updateEdgeChecksum(header.checksum, edge);
+        header.m++;
+    }
+
+    void finish(int n, int64_t source_size = 0, int64_t source_mtime = 0) {
+        header.n = n;
+        header.source_size = source_size;
+        header.source_mtime = source_mtime;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.close();
+        if (!out) throw runtime_error("failed to write binary graph");
+    }
+};
+
+
+bool isBinaryGraph(const MappedFile & file) {
+    return file.size() >= sizeof(BinaryGraphHeader) && memcmp(file.data(), BINARY_GRAPH_MAGIC, sizeof(BINARY_GRAPH_MAGIC)) == 0;
+}
+
+// Returns false if the file is not a valid binary graph of this version
+bool readBinaryGraph(const MappedFile & file, Graph & graph, BinaryGraphHeader & header) {
+    if (!isBinaryGraph(file)) return false;
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.version != BINARY_GRAPH_VERSION || header.header_size != sizeof(BinaryGraphHeader)) return false;
+    if (header.n < 0 || header.n > INT_MAX || header.m < 0 || header.m > INT_MAX) return false;
+    // m is checked against the file size by division, a product could wrap around for a corrupt m
+    size_t edge_bytes = file.size() - sizeof(header); // isBinaryGraph checked that the header fits
+    if (edge_bytes % sizeof(Edge) != 0 || edge_bytes / sizeof(Edge) != (size_t)header.m) return false;
+
+    vector<Edge> edges(header.m);
+    memcpy(edges.data(), file.data() + sizeof(header), header.m * sizeof(Edge));
+
+    uint64_t checksum = EDGE_CHECKSUM_SEED;
+    for (auto & edge : edges) {
+        if (edge.u < 1 || edge.u > header.n || edge.v < 1 || edge.v > header.n || edge.u == edge.v) return false;
+        checksum = updateEdgeChecksum(checksum, edge);
+    }
+    if (checksum != header.checksum) return false;
+
+    mergeParallelEdges(header.n, edges);
+    graph = buildGraph(header.n, move(edges));
+    return true;
+}
+
+
+// Next to the input, or in cache_dir if one is given
+string graphCachePath(const string & path, const string & cache_dir = "") {
+    if (cache_dir.empty()) return path + ".graphcache";
+    size_t slash = path.find_last_of('/');
+    string name = slash == string::npos ? path : path.substr(slash + 1);
+    return cache_dir + "/" + name + ".graphcache";
+}
+
+int64_t modificationTimeNanoseconds(const struct stat & info) {
+    return (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+// Loads a .rud file or a binary graph file.
+// With use_cache, a parsed .rud file is saved as a binary cache (next to it, or in cache_dir), which
+// later loads reuse as long as the .rud file keeps the same size and nanosecond modification time.
+Graph loadGraph(const string & path, bool use_cache = false, const string & cache_dir = "") {
+    TRACE_SCOPE("loadGraph");
+    struct stat source;
+    if (stat(path.c_str(), &source) != 0) throw runtime_error("cannot open " + path);
+    int64_t source_mtime = modificationTimeNanoseconds(source);
+
+    {
+        MappedFile file(path);
+        Graph graph;
+        BinaryGraphHeader header;
+        if (isBinaryGraph(file)) {
+            if (!readBinaryGraph(file, graph, header)) throw runtime_error("corrupt binary graph " + path);
+            return graph;
+        }
+    }
+
+    string cache_path = graphCachePath(path, cache_dir);
+    if (use_cache && access(cache_path.c_str(), R_OK) == 0) {
+        MappedFile file(cache_path);
+        Graph graph;
+        BinaryGraphHeader header;
+        if (readBinaryGraph(file, graph, header) && header.source_size == source.st_size && header.source_mtime == source_mtime) {
+            return graph;
+        }
+    }
+
+    Graph graph = loadRudGraph(path);
+
+    if (use_cache) {
+        // Written under a temporary name and renamed, so concurrent loads never see a partial cache
+        string temporary_path = cache_path + ".tmp" + to_string(getpid()) + "_" + to_string(hash<thread::id>{}(this_thread::get_id()));
+        try {
+            BinaryGraphWriter writer(temporary_path);
+            for (auto & edge : graph.edges) writer.add(edge);
+            writer.finish(graph.n, source.st_size, source_mtime);
+            rename(temporary_path.c_str(), cache_path.c_str());
+        } catch (const exception &) {
+            remove(temporary_path.c_str()); // the cache is optional
+        }
+    }
+    return graph;
+}
+
+#endif
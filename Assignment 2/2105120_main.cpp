@@ -1,7 +1,16 @@
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <mutex>
 #include "2105120_algorithms.hpp"
+#include "2105120_loader.hpp"
+#include "2105120_spectral.hpp"
+#include "2105120_multilevel.hpp"
+#include "2105120_benchmark.hpp"
+#include "2105120_islands.hpp"
+#include "2105120_memetic.hpp"
+#include "2105120_annealing.hpp"
 
 using namespace std;
 namespace fs = filesystem;
@@ -38,21 +47,274 @@ vector<int> get_known_best_solutions() {
 }
 
 
-void write_CSV_header(ofstream & csv, double alpha) {
+void write_CSV_header(ofstream & csv, double alpha, bool memetic, bool annealing) {
     // First header row (category headers)
-    csv << ",Problem,,,Constructive Algorithm,,Local Search,,GRASP,,Known Best Solution or Upper Bound" << endl;
+    csv << ",Problem,,,Constructive Algorithm,,Local Search,,GRASP,,Known Best Solution or Upper Bound,Spectral,,,"
+        << (memetic ? "Memetic,," : "") << (annealing ? "Simulated annealing,," : "") << "Median wall time (seconds),,,,," << endl;
 
     // Second header row (column names)
     csv << "Name,|V| or n,|E| or m,"
             << "Simple randomized,Simple greedy,Semi greedy(Alpha = " << alpha << "),"
             << "No. of iterations,Average value,"
             << "No. of iterations,Best value,"
-            << "" << endl;
+            << ","
+            << "Spectral rounding,Upper bound,Eigenvalue estimate,"
+            << (memetic ? "Generations,Best value," : "")
+            << (annealing ? "Accepted moves,Best value," : "")
+            << "Load,Randomized,Greedy,Semi greedy,Local search,GRASP" << endl;
 
     csv.flush();
     cout << "Header format written to CSV file" << endl;
 }
 
+struct ExperimentSettings {
+    double alpha = 0.5;
+    uint64_t seed = 0;
+    int grasp_threads = 1; // threads given to GRASP inside one instance
+    bool use_cache = false; // keep a binary cache of every parsed .rud file
+    string cache_dir; // where the caches go, next to the inputs if empty
+    long long bls_moves = 0; // breakout local search moves after every GRASP local search, 0 disables it
+    double time_limit = 0; // seconds per GRASP run, 0 means the fixed iteration counts
+    int ttt_runs = 0; // time-to-target runs per instance with a known best solution
+    double target_ratio = 1.0; // time-to-target target as a fraction of the known best solution
+    bool reactive = false; // reactive GRASP, alpha adapted per instance
+    int vnd_shakes = -1; // GRASP improves with variable neighborhood descent and this many shakes, -1 disables it
+    int multilevel_min_vertices = 0; // graphs with at least this many vertices are solved by the multilevel GRASP, 0 disables it
+    int repeats = 1; // timed runs per instance, the first one gives the cut values
+    double dense_density = 0.05; // graphs at least this dense use the dense weight matrix, above 1 disables it
+    double dense_max_bytes = 512.0 * (1 << 20); // largest dense matrix allowed
+    int islands = 1; // GRASP worker processes of the island model, 1 runs GRASP in this process
+    int migration_interval = 10; // island iterations between migrations
+    int memetic_generations = 0; // generations of the memetic algorithm, 0 does not run it
+    int annealing_sweeps = 0; // sweeps of simulated annealing, 0 does not run it
+    int annealing_replicas = 1; // more than one runs parallel tempering
+};
+
+// Extra CSV outputs shared by the workers, every write takes the lock
+struct SideOutputs {
+    mutex lock;
+    ofstream improvements; // Name,Elapsed seconds,Cut weight,Iteration
+    ofstream time_to_target; // Name,Target,Runs,Reached,Mean,Median,P90
+    ofstream alpha_distribution; // Name,Alpha,Probability,Uses
+};
+
+mutex log_mutex;
+
+void log_line(const string & line) {
+    lock_guard<mutex> lock(log_mutex);
+    cout << line << endl;
+}
+
+
+// Loads and solves one instance, adds the wall time of every phase to benchmark and returns the
+// results.csv row without the timing columns. Run 0 produces the reported values and side outputs,
+// later runs (repeat > 0) only time the phases, each with its own seed.
+// Only reads shared state, so several instances can be processed at the same time.
+string process_instance(const fs::directory_entry & entry, const ExperimentSettings & settings, const vector<int> & known_best_solutions,
+                        SideOutputs & outputs, int repeat, InstanceBenchmark & benchmark) {
+    string input_path = entry.path().string();
+    string filename = entry.path().stem().string(); // e.g., "g1"
+    bool first_run = repeat == 0;
+    TRACE_SCOPE("instance " + filename);
+
+    Stopwatch phase_stopwatch;
+    auto end_phase = [&](BenchmarkPhase phase) {
+        benchmark.seconds[phase].push_back(phase_stopwatch.elapsed());
+        phase_stopwatch = Stopwatch();
+    };
+
+    Graph graph = loadGraph(input_path, settings.use_cache, settings.cache_dir);
+    int n = graph.n, m = graph.m;
+
+    // Dense graphs also get a dense weight matrix, the dense construction and local search give the
+    // same partitions as the sparse ones, only faster
+    DenseMatrix dense;
+    double dense_bytes = 4.0 * (n + 1) * (n + 8);
+    bool use_dense = edgeDensity(graph) >= settings.dense_density && dense_bytes <= settings.dense_max_bytes;
+    if(use_dense) dense = buildDenseMatrix(graph);
+    end_phase(LOAD_PHASE);
+    benchmark.name = filename;
+    benchmark.n = n;
+    benchmark.m = m;
+
+    // Run the algorithms
+
+    if(first_run) log_line("Processing file: " + filename);
+
+    // Every instance gets its own seed derived from the master seed
+    uint64_t instance_seed = mix64(settings.seed ^ stoi(filename.substr(1)));
+    if(!first_run) instance_seed = mix64(instance_seed + repeat);
+    RandomStream gen(instance_seed);
+
+    phase_stopwatch = Stopwatch();
+    RandomizedCutResult randomized = RandomizedHeuristicMaxCut(graph, gen);
+    int randomized_average_cut_weight = randomized.average_cut_weight;
+    end_phase(RANDOMIZED_PHASE);
+    Partition greedy_partition = GreedyMaxCut(graph);
+    int greedy_cut_weight = greedy_partition.cut_weight;
+    end_phase(GREEDY_PHASE);
+    Partition semi_greedy_partition = use_dense ? SemiGreedyMaxCutDense(graph, dense, settings.alpha, gen)
+                                                : SemiGreedyMaxCut(graph, settings.alpha, gen);
+    int semi_greedy_cut_weight = semi_greedy_partition.cut_weight;
+    end_phase(SEMI_GREEDY_PHASE);
+    int local_search_iterations = use_dense ? LocalSearchMaxCutDense(dense, semi_greedy_partition)
+                                            : LocalSearchMaxCut(graph, semi_greedy_partition);
+    int local_search_cut_weight = semi_greedy_partition.cut_weight;
+    end_phase(LOCAL_SEARCH_PHASE);
+
+    checkCutWeight(graph, greedy_partition);
+    checkCutWeight(graph, semi_greedy_partition);
+
+    SpectralResult spectral;
+    int spectral_cut_weight = 0;
+    if(first_run) {
+        Partition spectral_partition = SpectralMaxCut(graph, gen, &spectral);
+        spectral_cut_weight = spectral_partition.cut_weight;
+    }
+
+    int grasp_iterations= 50;
+    if(n > 1000 && m > 10000) {
+        grasp_iterations = 20;
+    }
+
+    int known_best_solution_index = stoi(filename.substr(1)) - 1;
+    int known_best_value = 0;
+    if(known_best_solution_index < (int)known_best_solutions.size()) {
+        known_best_value = known_best_solutions[known_best_solution_index];
+    }
+
+    string known_best_solution = "N/A";
+    if(known_best_value != 0) {
+        known_best_solution = to_string(known_best_value);
+    }
+
+    GRASPOptions grasp_options;
+    grasp_options.iterations = grasp_iterations;
+    grasp_options.alpha = settings.alpha;
+    grasp_options.seed = mix64(instance_seed);
+    grasp_options.threads = settings.grasp_threads;
+    grasp_options.breakout_local_search = settings.bls_moves > 0;
+    grasp_options.tabu.max_moves = settings.bls_moves;
+    grasp_options.time_limit = settings.time_limit;
+    grasp_options.reactive = settings.reactive;
+    grasp_options.variable_neighborhood_descent = settings.vnd_shakes >= 0;
+    grasp_options.vnd.shakes = max(0, settings.vnd_shakes);
+    if(use_dense) grasp_options.dense = &dense;
+
+    if(settings.time_limit > 0 && first_run) {
+        grasp_options.on_improvement = [&](const ImprovementEvent & event) {
+            lock_guard<mutex> lock(outputs.lock);
+            outputs.improvements << filename << "," << event.elapsed << "," << event.cut_weight << "," << event.iteration << "\n";
+        };
+    }
+
+    GRASPStats grasp_stats;
+    Partition grasp_partition;
+    phase_stopwatch = Stopwatch();
+    if(settings.multilevel_min_vertices > 0 && graph.n >= settings.multilevel_min_vertices) {
+        MultilevelOptions multilevel_options;
+        multilevel_options.seed = grasp_options.seed;
+        multilevel_options.grasp = grasp_options;
+        multilevel_options.grasp.on_improvement = nullptr; // the events would belong to the coarsest graph
+        multilevel_options.grasp.dense = nullptr; // the matrix is the one of the fine graph
+        int levels = 0;
+        grasp_partition = MultilevelMaxCut(graph, multilevel_options, &levels, &grasp_stats);
+        if(first_run) log_line("Multilevel " + filename + ": " + to_string(levels) + " levels");
+    } else if(settings.islands > 1) {
+        IslandOptions island_options;
+        island_options.islands = settings.islands;
+        island_options.migration_interval = settings.migration_interval;
+        IslandStats island_stats;
+        grasp_partition = IslandGRASP(graph, grasp_options, island_options, &island_stats);
+        grasp_stats.iterations = island_stats.iterations;
+        if(first_run) {
+            log_line("Islands " + filename + ": " + to_string(island_stats.migrants_accepted) + " of "
+                     + to_string(island_stats.migrants_received) + " migrants accepted");
+        }
+    } else {
+        grasp_partition = GRASP(graph, grasp_options, &grasp_stats);
+    }
+    int grasp_cut_weight = grasp_partition.cut_weight;
+    grasp_iterations = grasp_stats.iterations;
+    end_phase(GRASP_PHASE);
+
+    if(!first_run) return "";
+
+    // The memetic algorithm gets the same improvement method, threads and time limit as GRASP
+    MemeticStats memetic_stats;
+    Partition memetic_partition;
+    if(settings.memetic_generations > 0) {
+        MemeticOptions memetic_options;
+        memetic_options.generations = settings.memetic_generations;
+        memetic_options.time_limit = settings.time_limit;
+        memetic_options.seed = mix64(instance_seed + 1); // GRASP uses mix64(instance_seed)
+        memetic_options.threads = settings.grasp_threads;
+        memetic_options.alpha = settings.alpha;
+        memetic_options.variable_neighborhood_descent = grasp_options.variable_neighborhood_descent;
+        memetic_options.vnd = grasp_options.vnd;
+        memetic_options.dense = grasp_options.dense;
+        memetic_partition = MemeticMaxCut(graph, memetic_options, &memetic_stats);
+    }
+
+    // Simulated annealing (or parallel tempering) from a random partition
+    long long annealing_moves = 0;
+    Partition annealing_partition;
+    if(settings.annealing_sweeps > 0) {
+        RandomStream annealing_gen(instance_seed, 2);
+        annealing_partition.in_x.assign(n + 1, 0);
+        for (int v = 1; v <= n; v++) annealing_partition.in_x[v] = annealing_gen() & 1;
+        annealing_partition.cut_weight = calculateCutWeight(graph, annealing_partition.in_x);
+
+        AnnealingOptions annealing_options;
+        annealing_options.sweeps = settings.annealing_sweeps;
+        annealing_options.time_limit = settings.time_limit;
+        annealing_options.seed = mix64(instance_seed + 2);
+        annealing_options.replicas = settings.annealing_replicas;
+        annealing_options.threads = settings.grasp_threads;
+        annealing_moves = settings.annealing_replicas > 1 ? ParallelTemperingMaxCut(graph, annealing_partition, annealing_options)
+                                                          : SimulatedAnnealingMaxCut(graph, annealing_partition, annealing_options);
+    }
+
+    if(settings.reactive) {
+        lock_guard<mutex> lock(outputs.lock);
+        for (size_t k = 0; k < grasp_stats.alphas.size(); k++) {
+            outputs.alpha_distribution << filename << "," << grasp_stats.alphas[k] << "," << grasp_stats.alpha_probabilities[k] << "," << grasp_stats.alpha_uses[k] << "\n";
+        }
+    }
+
+    if(settings.ttt_runs > 0 && known_best_value != 0) {
+        GRASPOptions ttt_options = grasp_options;
+        if(ttt_options.time_limit <= 0) ttt_options.time_limit = 10;
+        int target = (int)ceil(settings.target_ratio * known_best_value);
+        TimeToTargetStats ttt = measureTimeToTarget(graph, ttt_options, target, settings.ttt_runs);
+
+        lock_guard<mutex> lock(outputs.lock);
+        outputs.time_to_target << filename << "," << target << "," << ttt.runs << "," << ttt.reached << ","
+                               << ttt.mean << "," << ttt.median << "," << ttt.p90 << "\n";
+    }
+
+    ostringstream row;
+    row << filename << ","
+        << n << "," << m << ","
+        << randomized_average_cut_weight << ","
+        << greedy_cut_weight << ","
+        << semi_greedy_cut_weight << ","
+        << local_search_iterations << "," << local_search_cut_weight << ","
+        << grasp_iterations << "," << grasp_cut_weight << ","
+        << known_best_solution << ","
+        << spectral_cut_weight << "," << spectral.upper_bound << "," << spectral.estimate;
+    if(settings.memetic_generations > 0) {
+        row << "," << memetic_stats.generations << "," << memetic_partition.cut_weight;
+    }
+    if(settings.annealing_sweeps > 0) {
+        row << "," << annealing_moves << "," << annealing_partition.cut_weight;
+    }
+
+    log_line("Processed file: " + filename);
+    return row.str();
+}
+
+
 int main(int argc, char *argv[]) {
     vector<int> known_best_solutions = get_known_best_solutions();
 
@@ -60,17 +322,140 @@ int main(int argc, char *argv[]) {
     string input_dir = "set1/";  // Default directory
     string output_file = "results.csv";  // Default output file
 
-    if(argc == 3) {
-        input_dir = argv[1];
-        output_file = argv[2];
+    uint64_t seed = random_device{}();  // Master seed, printed so that a run can be reproduced
+    int threads = defaultThreadCount(); // total core budget
+    int workers = 0; // instances processed at the same time, 0 means one per thread
+    bool use_cache = false;
+    string cache_dir;
+    long long bls_moves = 0;
+    double time_limit = 0;
+    int ttt_runs = 0;
+    double target_ratio = 1.0;
+    bool reactive = false;
+    int vnd_shakes = -1;
+    int multilevel_min_vertices = 0;
+    int repeats = 1;
+    string json_file, baseline_file;
+    double tolerance = 0.1;
+    string trace_file;
+    double dense_density = 0.05;
+    int islands = 1;
+    int migration_interval = 10;
+    int memetic_generations = 0;
+    int annealing_sweeps = 0;
+    int annealing_replicas = 1;
+
+    // Usage: main [input_dir output_file] [--seed=N] [--threads=N] [--workers=N] [--cache[=DIR]] [--bls=MOVES]
+    //             [--time-limit=SECONDS] [--ttt=RUNS] [--target-ratio=R] [--reactive] [--vnd=SHAKES]
+    //             [--multilevel=MIN_VERTICES] [--repeat=RUNS] [--json=PATH] [--baseline=PATH] [--tolerance=R]
+    //             [--trace=PATH] [--dense=DENSITY] [--islands=PROCESSES] [--migration=ITERATIONS]
+    //             [--memetic=GENERATIONS] [--annealing=SWEEPS] [--replicas=CHAINS]
+    // Each of the workers gives threads / workers threads to GRASP.
+    // --cache keeps a binary copy of every parsed .rud file next to it, or in DIR, for faster reloads.
+    // Benchmarking: every instance is run RUNS times and the median wall time of each phase is added
+    // to the CSV, --json writes percentiles, --baseline compares the medians with an earlier --json
+    // summary and fails on phases slower by more than the tolerance (default 10%). Use --workers=1
+    // for timings that are not disturbed by other instances.
+    // --trace writes a Chrome trace of the algorithm phases and prints the hot path counters, it needs a
+    // build with -DMAXCUT_TRACE.
+    // Graphs with an edge density of at least DENSITY (default 0.05) are also stored as a dense matrix
+    // for the SIMD construction and local search kernels, --dense=2 turns that off.
+    // With --islands, GRASP runs as an island model on that many forked processes, each with the full
+    // iteration budget, exchanging elite partitions every --migration iterations (default 10).
+    // --memetic adds the memetic algorithm next to GRASP, stopped after GENERATIONS or the time limit.
+    // --annealing adds simulated annealing with SWEEPS temperature steps of n moves, or with
+    // --replicas above 1 parallel tempering with that many chains of SWEEPS sweeps each.
+    vector<string> positional;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--seed=", 0) == 0) seed = stoull(arg.substr(7));
+        else if (arg.rfind("--threads=", 0) == 0) threads = max(1, stoi(arg.substr(10)));
+        else if (arg.rfind("--workers=", 0) == 0) workers = max(1, stoi(arg.substr(10)));
+        else if (arg == "--cache") use_cache = true;
+        else if (arg.rfind("--cache=", 0) == 0) {
+            use_cache = true;
+            cache_dir = arg.substr(8);
+        }
+        else if (arg.rfind("--bls=", 0) == 0) bls_moves = stoll(arg.substr(6));
+        else if (arg.rfind("--time-limit=", 0) == 0) time_limit = stod(arg.substr(13));
+        else if (arg.rfind("--ttt=", 0) == 0) ttt_runs = stoi(arg.substr(6));
+        else if (arg.rfind("--target-ratio=", 0) == 0) target_ratio = stod(arg.substr(15));
+        else if (arg == "--reactive") reactive = true;
+        else if (arg.rfind("--vnd=", 0) == 0) vnd_shakes = stoi(arg.substr(6));
+        else if (arg.rfind("--multilevel=", 0) == 0) multilevel_min_vertices = stoi(arg.substr(13));
+        else if (arg.rfind("--repeat=", 0) == 0) repeats = max(1, stoi(arg.substr(9)));
+        else if (arg.rfind("--json=", 0) == 0) json_file = arg.substr(7);
+        else if (arg.rfind("--baseline=", 0) == 0) baseline_file = arg.substr(11);
+        else if (arg.rfind("--tolerance=", 0) == 0) tolerance = stod(arg.substr(12));
+        else if (arg.rfind("--trace=", 0) == 0) trace_file = arg.substr(8);
+        else if (arg.rfind("--dense=", 0) == 0) dense_density = stod(arg.substr(8));
+        else if (arg.rfind("--islands=", 0) == 0) islands = max(1, stoi(arg.substr(10)));
+        else if (arg.rfind("--migration=", 0) == 0) migration_interval = max(1, stoi(arg.substr(12)));
+        else if (arg.rfind("--memetic=", 0) == 0) memetic_generations = max(0, stoi(arg.substr(10)));
+        else if (arg.rfind("--annealing=", 0) == 0) annealing_sweeps = max(0, stoi(arg.substr(12)));
+        else if (arg.rfind("--replicas=", 0) == 0) annealing_replicas = max(1, stoi(arg.substr(11)));
+        else positional.push_back(arg);
+    }
+
+    if(positional.size() == 2) {
+        input_dir = positional[0];
+        output_file = positional[1];
     }
+    if(islands > 1 && (reactive || time_limit > 0)) {
+        // islands run in other processes, their alpha statistics and improvement events would be lost
+        cerr << "--islands cannot be combined with --reactive or --time-limit" << endl;
+        return 1;
+    }
+    if(workers == 0) workers = threads;
+    workers = min(workers, threads);
+    if(islands > 1) workers = 1; // islands fork, which is only safe while no other thread is running
+    cout << "Seed: " << seed << ", threads: " << threads << ", workers: " << workers << endl;
 
     // Open CSV file for writing
     csv_file.open(output_file);
 
-    double alpha = 0.5; // Default alpha value
+    ExperimentSettings settings;
+    settings.alpha = 0.5; // Default alpha value
+    settings.seed = seed;
+    settings.grasp_threads = max(1, threads / workers);
+    settings.use_cache = use_cache;
+    settings.cache_dir = cache_dir;
+    settings.bls_moves = bls_moves;
+    settings.time_limit = time_limit;
+    settings.ttt_runs = ttt_runs;
+    settings.target_ratio = target_ratio;
+    settings.reactive = reactive;
+    settings.vnd_shakes = vnd_shakes;
+    settings.multilevel_min_vertices = multilevel_min_vertices;
+    settings.repeats = repeats;
+    settings.dense_density = dense_density;
+    settings.islands = islands;
+    settings.migration_interval = migration_interval;
+    settings.memetic_generations = memetic_generations;
+    settings.annealing_sweeps = annealing_sweeps;
+    settings.annealing_replicas = annealing_replicas;
+
+    // Anytime runs stream their improvements, time-to-target runs their statistics and reactive runs
+    // their alpha distributions to files next to the results
+    SideOutputs outputs;
+    fs::path output_path(output_file);
+    auto side_output_path = [&](const string & suffix) {
+        return (output_path.parent_path() / (output_path.stem().string() + suffix)).string();
+    };
+    if(time_limit > 0) {
+        outputs.improvements.open(side_output_path("_improvements.csv"));
+        outputs.improvements << "Name,Elapsed seconds,Cut weight,Iteration\n";
+    }
+    if(reactive) {
+        outputs.alpha_distribution.open(side_output_path("_alpha.csv"));
+        outputs.alpha_distribution << "Name,Alpha,Probability,Uses\n";
+    }
+    if(ttt_runs > 0) {
+        outputs.time_to_target.open(side_output_path("_ttt.csv"));
+        outputs.time_to_target << "Name,Target,Runs,Reached,Mean seconds,Median seconds,P90 seconds\n";
+    }
 
-    write_CSV_header(csv_file, alpha);
+    write_CSV_header(csv_file, settings.alpha, memetic_generations > 0, annealing_sweeps > 0);
 
 
     vector<fs::directory_entry> files;
@@ -86,77 +471,52 @@ int main(int argc, char *argv[]) {
 
 
 
-    for (const auto &entry : files) {
-            string input_path = entry.path().string();
-            string filename = entry.path().stem().string(); // e.g., "g1"
-
-            // Redirect input and output
-            ifstream in(input_path);
-            cin.rdbuf(in.rdbuf());
-
-            int n, m;
-            cin >> n >> m;
-            vector<vector<int>> weights(n, vector<int>(n, 0));
-            for (int i = 0; i < m; i++) {
-                int u, v, w;
-                cin >> u >> v >> w;
-                weights[u - 1][v - 1] = w;
-                weights[v - 1][u - 1] = w;
-            }
-
-            vector<pair<pair<int,int>, int>> edges;
-            for (int i = 0; i < n; i++) {
-                for (int j = 0; j < n; j++) {
-                    if (i < j && weights[i][j] != 0) {
-                        edges.push_back({{i + 1, j + 1}, weights[i][j]});
-                    }
-                }
-            }
-
-            // Run the algorithms
-
-            cout << "Processing file: " << filename << endl;
-
-            int randomized_average_cut_weight = RandomizedHeuristicMaxCut(n, edges);
-            auto greedy_partition = GreedyMaxCut(n, weights);
-            int greedy_cut_weight = calculateCutWeight(greedy_partition.first, greedy_partition.second, weights);
-            auto semi_greedy_partition = SemiGreedyMaxCut(n, weights, alpha);
-            int semi_greedy_cut_weight = calculateCutWeight(semi_greedy_partition.first, semi_greedy_partition.second, weights);
-            int local_search_iterations = LocalSearchMaxCut(n, weights, semi_greedy_partition.first, semi_greedy_partition.second);
-            int local_search_cut_weight = calculateCutWeight(semi_greedy_partition.first, semi_greedy_partition.second, weights);
-
-            int grasp_iterations= 50;
-            if(n > 1000 && m > 10000) {
-                grasp_iterations = 20;
-            }
-
-            auto grasp_partition = GRASP(n, weights, grasp_iterations, alpha);
-            int grasp_cut_weight = calculateCutWeight(grasp_partition.first, grasp_partition.second, weights);
-
-            int known_best_solution_index = stoi(filename.substr(1)) - 1;
-
-            string known_best_solution = "N/A";
-            if(known_best_solutions[known_best_solution_index] != 0) {
-                known_best_solution = to_string(known_best_solutions[known_best_solution_index]);
-            }
-            // Write results to CSV
-
-            csv_file << filename << ","
-                     << n << "," << m << ","
-                     << randomized_average_cut_weight << ","
-                     << greedy_cut_weight << ","
-                     << semi_greedy_cut_weight << ","
-                     << local_search_iterations << "," << local_search_cut_weight << ","
-                     << grasp_iterations << "," << grasp_cut_weight << ","
-                     << known_best_solution
-                     << endl;
-            cout << "Processed file: " << filename << endl;
-            in.close();
-            csv_file.flush();
-    }
+    // Instances are solved concurrently, rows are written as soon as every earlier file is done
+    vector<string> rows(files.size());
+    vector<bool> done(files.size(), false);
+    size_t next_row = 0;
+    mutex csv_mutex;
+    vector<InstanceBenchmark> benchmarks(files.size());
+
+    parallelFor(files.size(), workers, [&](int i) {
+        string row = process_instance(files[i], settings, known_best_solutions, outputs, 0, benchmarks[i]);
+        for (int repeat = 1; repeat < settings.repeats; repeat++) {
+            process_instance(files[i], settings, known_best_solutions, outputs, repeat, benchmarks[i]);
+        }
+        for (int phase = 0; phase < PHASE_COUNT; phase++) row += "," + to_string(benchmarks[i].median(phase));
+
+        lock_guard<mutex> lock(csv_mutex);
+        rows[i] = row;
+        done[i] = true;
+        while (next_row < files.size() && done[next_row]) {
+            csv_file << rows[next_row++] << endl;
+        }
+        csv_file.flush();
+    });
 
     csv_file.close();
     cout << "Results written to " << output_file << endl;
 
+    if(!json_file.empty()) {
+        writeBenchmarkJSON(json_file, benchmarks, seed, repeats);
+        cout << "Benchmark summary written to " << json_file << endl;
+    }
+    if(!trace_file.empty()) {
+#ifdef MAXCUT_TRACE
+        Tracer::instance().writeChromeTrace(trace_file);
+        for (int c = 0; c < TRACE_COUNTER_COUNT; c++) {
+            cout << TRACE_COUNTER_NAMES[c] << ": " << Tracer::instance().total((TraceCounter)c) << endl;
+        }
+        cout << "Trace written to " << trace_file << endl;
+#else
+        cout << "--trace ignored, build with -DMAXCUT_TRACE to record a trace" << endl;
+#endif
+    }
+    if(!baseline_file.empty()) {
+        int regressions = compareWithBaseline(benchmarks, readBenchmarkMedians(baseline_file), tolerance, cout);
+        cout << regressions << " regressions against " << baseline_file << endl;
+        if(regressions > 0) return 1;
+    }
+
     return 0;
 }
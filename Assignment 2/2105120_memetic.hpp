@@ -0,0 +1,164 @@
+#ifndef MEMETIC_HPP
+#define MEMETIC_HPP
+
+#include <vector>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include <limits>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_random.hpp"
+#include "2105120_parallel.hpp"
+#include "2105120_timing.hpp"
+#include "2105120_algorithms.hpp"
+
+using namespace std;
+
+// Memetic algorithm: a population of local optima evolved by crossover and local search.
+// Every generation creates `offspring` children from tournament-selected parents. A child keeps
+// the sides its parents agree on (after aligning the second parent with the mirror image that is
+// closer to the first) and places the other vertices greedily in random order. It is then improved
+// by local search. Children are built and improved in parallel, each from its own random stream,
+// and enter the population in child order, so the result does not depend on the number of threads.
+//
+// Diversity: a child that duplicates a member is dropped. A child closer than min_distance to some
+// member may only replace that member, and only if it is better. Any other child replaces the worst
+// member if it is better than it. After restart_after generations without a replacement, everything
+// but the best member is rebuilt from semi-greedy starts.
+
+struct MemeticOptions {
+    int population_size = 20;
+    int offspring = 20; // children per generation
+    int generations = 50;
+    double time_limit = 0; // seconds, 0 means no time limit
+    uint64_t seed = 0;
+    int threads = 1;
+    double alpha = 0.5; // semi-greedy construction of the initial population and of restarts
+    double min_distance = 0.05; // fraction of n
+    int restart_after = 10;
+    bool variable_neighborhood_descent = false; // improve with VND instead of best-improvement local search
+    VNDOptions vnd;
+    const DenseMatrix * dense = nullptr; // dense weights for construction and local search, when set
+};
+
+struct MemeticStats {
+    int generations = 0;
+    int offspring = 0; // children created
+    int replacements = 0; // children that entered the population
+    int restarts = 0;
+    double elapsed = 0;
+};
+
+
+// Child of a and b: agreed sides are kept, the rest is placed greedily in random order
+Partition agreementCrossover(const Graph & graph, const Partition & a, const Partition & b, RandomStream & gen) {
+    int n = graph.n;
+    int different = 0;
+    for (int v = 1; v <= n; v++) different += a.in_x[v] != b.in_x[v];
+    bool mirrored = different > n - different;
+
+    ConstructionState state(graph);
+    vector<int> free_vertices;
+    for (int v = 1; v <= n; v++) {
+        if ((a.in_x[v] != b.in_x[v]) == mirrored) state.place(v, a.in_x[v] ? 'x' : 'y');
+        else free_vertices.push_back(v);
+    }
+    shuffle(free_vertices.begin(), free_vertices.end(), gen);
+    for (int v : free_vertices) state.place(v, state.bestSide(v));
+    return state.partition();
+}
+
+
+Partition MemeticMaxCut(const Graph & graph, const MemeticOptions & options, MemeticStats * stats = nullptr) {
+    TRACE_SCOPE("MemeticMaxCut");
+    Stopwatch stopwatch;
+    int n = graph.n;
+    int population_size = max(2, options.population_size);
+    int min_distance = max(1, (int)(options.min_distance * n));
+    MemeticStats local_stats;
+
+    auto improve = [&](Partition & partition, RandomStream & gen) {
+        if (options.variable_neighborhood_descent) VariableNeighborhoodDescent(graph, partition, gen, options.vnd);
+        else if (options.dense != nullptr) LocalSearchMaxCutDense(*options.dense, partition);
+        else LocalSearchMaxCut(graph, partition);
+        checkCutWeight(graph, partition);
+    };
+
+    // Stream of a semi-greedy start, apart from the child streams
+    long long starts = 0;
+    auto buildStarts = [&](vector<Partition> & members, int first) {
+        long long base = starts;
+        parallelFor(members.size() - first, options.threads, [&](int i) {
+            RandomStream gen(options.seed, (1ULL << 62) | (base + i));
+            members[first + i] = options.dense != nullptr ? SemiGreedyMaxCutDense(graph, *options.dense, options.alpha, gen)
+                                                          : SemiGreedyMaxCut(graph, options.alpha, gen);
+            improve(members[first + i], gen);
+        });
+        starts += members.size() - first;
+    };
+
+    vector<Partition> population(population_size);
+    buildStarts(population, 0);
+
+    auto best_member = [&]() {
+        return (int)(max_element(population.begin(), population.end(), [](const Partition & a, const Partition & b) { return a.cut_weight < b.cut_weight; }) - population.begin());
+    };
+
+    int stagnant_generations = 0;
+    for (int generation = 0; generation < options.generations; generation++) {
+        if (options.time_limit > 0 && stopwatch.elapsed() >= options.time_limit) break;
+
+        vector<Partition> children(max(1, options.offspring));
+        parallelFor(children.size(), options.threads, [&](int j) {
+            RandomStream gen(options.seed, (uint64_t)generation * children.size() + j);
+            uniform_int_distribution<int> member(0, population_size - 1);
+            auto tournament = [&]() {
+                int first = member(gen), second = member(gen);
+                return population[first].cut_weight >= population[second].cut_weight ? first : second;
+            };
+            int a = tournament(), b = tournament();
+            while (b == a) b = member(gen);
+
+            children[j] = agreementCrossover(graph, population[a], population[b], gen);
+            improve(children[j], gen);
+        });
+        local_stats.offspring += children.size();
+
+        bool replaced = false;
+        for (auto & child : children) {
+            int closest = -1, closest_distance = numeric_limits<int>::max(), worst = 0;
+            for (int i = 0; i < population_size; i++) {
+                int distance = partitionDistance(child, population[i]);
+                if (distance < closest_distance) {
+                    closest = i;
+                    closest_distance = distance;
+                }
+                if (population[i].cut_weight < population[worst].cut_weight) worst = i;
+            }
+            if (closest_distance == 0) continue;
+
+            int target = closest_distance < min_distance ? closest : worst;
+            if (child.cut_weight > population[target].cut_weight) {
+                population[target] = move(child);
+                local_stats.replacements++;
+                replaced = true;
+            }
+        }
+
+        stagnant_generations = replaced ? 0 : stagnant_generations + 1;
+        if (stagnant_generations >= options.restart_after) {
+            swap(population[0], population[best_member()]);
+            buildStarts(population, 1);
+            local_stats.restarts++;
+            stagnant_generations = 0;
+        }
+        local_stats.generations++;
+    }
+
+    local_stats.elapsed = stopwatch.elapsed();
+    if (stats != nullptr) *stats = local_stats;
+    return population[best_member()];
+}
+
+#endif
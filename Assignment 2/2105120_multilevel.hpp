@@ -0,0 +1,158 @@
+#ifndef MULTILEVEL_HPP
+#define MULTILEVEL_HPP
+
+#include <vector>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_algorithms.hpp"
+#include "2105120_vnd.hpp"
+
+using namespace std;
+
+// Multilevel max-cut: coarsen by heavy-edge matching, solve the coarsest graph with GRASP, then
+// project the partition back level by level and refine it with incremental local search.
+//
+// Contracting u and v ties their sides together. For a positive edge the heavy side is opposite
+// sides, so v is merged "flipped": side(v) = !side(coarse vertex). A fine edge (a, b, w) with
+// orientations o_a, o_b in {+1, -1} then becomes a coarse edge of weight w o_a o_b, plus a constant w
+// when o_a o_b = -1 (the edge is cut exactly when the coarse endpoints are on the same side). Edges
+// inside a coarse vertex are cut (o_a != o_b) or not, whatever the partition, so they only add to the
+// constant. Coarse cut + constant equals the fine cut for every projected partition.
+
+struct CoarseLevel {
+    Graph graph; // the coarse graph
+    vector<int> coarse_vertex; // fine vertex -> coarse vertex
+    vector<char> flipped; // 1 if the fine vertex is on the opposite side of its coarse vertex
+    int constant = 0; // fine cut = coarse cut + constant
+};
+
+
+CoarseLevel coarsen(const Graph & graph, RandomStream & gen) {
+    int n = graph.n;
+    CoarseLevel level;
+    level.coarse_vertex.assign(n + 1, 0);
+    level.flipped.assign(n + 1, 0);
+
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 1);
+    shuffle(order.begin(), order.end(), gen);
+
+    // Heavy-edge matching on |w|, in random vertex order
+    int coarse_n = 0;
+    vector<vector<int>> members(1);
+    for (int v : order) {
+        if (level.coarse_vertex[v]) continue;
+        int mate = 0, heaviest = 0;
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+            int u = graph.neighbor[i];
+            if (!level.coarse_vertex[u] && u != v && abs(graph.neighbor_weight[i]) > heaviest) {
+                heaviest = abs(graph.neighbor_weight[i]);
+                mate = u;
+            }
+        }
+
+        level.coarse_vertex[v] = ++coarse_n;
+        members.push_back({v});
+        if (mate) {
+            int weight = 0; // all parallel edges between v and mate decide the orientation together
+            for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+                if (graph.neighbor[i] == mate) weight += graph.neighbor_weight[i];
+            }
+            level.coarse_vertex[mate] = coarse_n;
+            level.flipped[mate] = weight > 0;
+            members.back().push_back(mate);
+        }
+    }
+
+    // Coarse adjacency, accumulated per coarse vertex through a dense scratch row
+    vector<int> accumulated(coarse_n + 1, 0);
+    vector<int> touched_by(coarse_n + 1, 0);
+    vector<int> touched;
+    vector<Edge> edges;
+    for (int c = 1; c <= coarse_n; c++) {
+        for (int a : members[c]) {
+            int sign_a = level.flipped[a] ? -1 : 1;
+            for (int i = graph.offset[a]; i < graph.offset[a+1]; i++) {
+                int b = graph.neighbor[i], w = graph.neighbor_weight[i];
+                int d = level.coarse_vertex[b];
+                int sign = sign_a * (level.flipped[b] ? -1 : 1);
+
+                // Every edge is seen from both ends, count it from the lower end only
+                if (d == c) {
+                    if (a < b && sign < 0) level.constant += w;
+                    continue;
+                }
+                if (d < c) continue;
+                if (sign < 0) level.constant += w;
+                if (touched_by[d] != c) {
+                    touched_by[d] = c;
+                    touched.push_back(d);
+                }
+                accumulated[d] += sign * w;
+            }
+        }
+        for (int d : touched) {
+            if (accumulated[d] != 0) edges.push_back({c, d, accumulated[d]}); // opposite edges may cancel out
+            accumulated[d] = 0;
+        }
+        touched.clear();
+    }
+
+    level.graph = buildGraph(coarse_n, move(edges));
+    return level;
+}
+
+
+// Fine partition from a coarse one, the cut follows from the level constant
+Partition projectPartition(const CoarseLevel & level, const Partition & coarse, int fine_n) {
+    Partition fine;
+    fine.in_x.assign(fine_n + 1, 0);
+    for (int v = 1; v <= fine_n; v++) fine.in_x[v] = coarse.in_x[level.coarse_vertex[v]] ^ level.flipped[v];
+    fine.cut_weight = coarse.cut_weight + level.constant;
+    return fine;
+}
+
+
+struct MultilevelOptions {
+    int coarsest_size = 500; // stop coarsening at this many vertices
+    double min_reduction = 0.9; // or when a level keeps more than this fraction of the vertices
+    uint64_t seed = 0;
+    GRASPOptions grasp; // solver of the coarsest graph
+    VNDOptions refinement; // local search at every finer level
+};
+
+
+// Returns the partition of the original graph, levels receives the number of coarse levels and stats
+// those of the GRASP run on the coarsest graph
+Partition MultilevelMaxCut(const Graph & graph, const MultilevelOptions & options, int * levels = nullptr, GRASPStats * stats = nullptr) {
+    TRACE_SCOPE("MultilevelMaxCut");
+    RandomStream gen(options.seed);
+    vector<CoarseLevel> hierarchy;
+
+    const Graph * current = &graph;
+    while (current->n > options.coarsest_size) {
+        CoarseLevel level = coarsen(*current, gen);
+        if (level.graph.n > options.min_reduction * current->n) break;
+        hierarchy.push_back(move(level));
+        current = &hierarchy.back().graph;
+    }
+    if (levels != nullptr) *levels = hierarchy.size();
+
+    GRASPOptions grasp_options = options.grasp;
+    grasp_options.seed = mix64(options.seed);
+    Partition partition = GRASP(*current, grasp_options, stats);
+
+    for (int i = (int)hierarchy.size() - 1; i >= 0; i--) {
+        const Graph & finer = i > 0 ? hierarchy[i-1].graph : graph;
+        partition = projectPartition(hierarchy[i], partition, finer.n);
+        checkCutWeight(finer, partition);
+        VariableNeighborhoodDescent(finer, partition, gen, options.refinement);
+    }
+    return partition;
+}
+
+#endif
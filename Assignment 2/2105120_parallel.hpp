@@ -0,0 +1,35 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int defaultThreadCount() {
+    return max(1u, thread::hardware_concurrency());
+}
+
+// Runs task(i) for every i in [0, count) on up to `threads` worker threads.
+// Workers take the next index from a shared counter, so uneven tasks are balanced.
+template <typename Task>
+void parallelFor(int count, int threads, Task task) {
+    threads = max(1, min(threads, count));
+    if (threads == 1) {
+        for (int i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    atomic<int> next_index(0);
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for (int i = next_index++; i < count; i = next_index++) task(i);
+        });
+    }
+    for (auto & worker : workers) worker.join();
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PARTITION_HPP
+#define PARTITION_HPP
+
+#include <vector>
+#include <cassert>
+#include "2105120_graph.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+// Two-way partition of the vertices together with the weight of the cut it induces.
+// The algorithms keep cut_weight up to date as they place and move vertices.
+struct Partition {
+    vector<char> in_x; // 1 indexed, 1 if the vertex is in partition x, 0 if it is in partition y
+    int cut_weight = 0;
+};
+
+
+// Full O(m) recomputation of the cut weight from the edge list
+int calculateCutWeight(const Graph & graph, const vector<char> & in_x) {
+    int cutWeight = 0;
+
+    for (auto & edge : graph.edges) {
+        if (in_x[edge.u] != in_x[edge.v]) cutWeight += edge.weight;
+    }
+
+    return cutWeight;
+}
+
+
+// Debug builds check the tracked cut weight against a full recomputation
+void checkCutWeight(const Graph & graph, const Partition & partition) {
+    assert(partition.cut_weight == calculateCutWeight(graph, partition.in_x));
+}
+
+
+// Flip gains of a partition: gain[v] is how much the cut weight grows if v changes sides.
+// Flipping a vertex updates its own gain and the gains of its neighbors in O(degree).
+struct GainState {
+    const Graph & graph;
+    Partition & partition;
+    vector<int> gain;
+
+    GainState(const Graph & graph, Partition & partition) : graph(graph), partition(partition), gain(graph.n + 1, 0) {
+        TRACE_COUNT(TRACE_GAIN_UPDATES, graph.n);
+        for (int v = 1; v <= graph.n; v++) {
+            for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+                int u = graph.neighbor[i];
+                gain[v] += partition.in_x[u] == partition.in_x[v] ? graph.neighbor_weight[i] : -graph.neighbor_weight[i];
+            }
+        }
+    }
+
+    void flip(int v) {
+        TRACE_COUNT(TRACE_FLIPS, 1);
+        TRACE_COUNT(TRACE_GAIN_UPDATES, graph.offset[v+1] - graph.offset[v] + 1);
+        partition.in_x[v] ^= 1;
+        partition.cut_weight += gain[v];
+        gain[v] = -gain[v];
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+            int u = graph.neighbor[i];
+            // the edge (u, v) was cut if u is now on the same side as v
+            gain[u] += partition.in_x[u] == partition.in_x[v] ? 2 * graph.neighbor_weight[i] : -2 * graph.neighbor_weight[i];
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef PATH_RELINKING_HPP
+#define PATH_RELINKING_HPP
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <random>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_random.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+// Number of vertices on different sides, up to swapping x and y (a partition and its mirror are the same cut)
+int partitionDistance(const Partition & a, const Partition & b) {
+    int n = (int)a.in_x.size() - 1;
+    int different = 0;
+    for (int v = 1; v <= n; v++) different += a.in_x[v] != b.in_x[v];
+    return min(different, n - different);
+}
+
+
+// Pool of diverse high quality partitions for path relinking
+class ElitePool {
+    int capacity;
+    int min_distance; // a new member must differ from every member in at least this many vertices
+    vector<Partition> members;
+
+public:
+    ElitePool(int capacity, int min_distance) : capacity(capacity), min_distance(max(1, min_distance)) {}
+
+    const vector<Partition> & partitions() const { return members; }
+    bool empty() const { return members.empty(); }
+
+    // Returns true if the partition was added
+    bool insert(const Partition & candidate) {
+        if (capacity <= 0) return false;
+
+        int best = numeric_limits<int>::min();
+        for (auto & member : members) best = max(best, member.cut_weight);
+
+        // A new best is always accepted, anything else must be far enough from every member
+        int closest = -1, closest_distance = numeric_limits<int>::max();
+        for (int i = 0; i < (int)members.size(); i++) {
+            int distance = partitionDistance(candidate, members[i]);
+            if (distance == 0) return false;
+            if (distance < min_distance && candidate.cut_weight <= best) return false;
+            if (members[i].cut_weight < candidate.cut_weight && distance < closest_distance) {
+                closest = i;
+                closest_distance = distance;
+            }
+        }
+
+        if ((int)members.size() < capacity) {
+            members.push_back(candidate);
+            return true;
+        }
+        // Full pool: replace the most similar member among those worse than the candidate
+        if (closest == -1) return false;
+        members[closest] = candidate;
+        return true;
+    }
+
+    // Guiding solution for path relinking, chosen with probability proportional to its distance
+    // from the partition, so that diverse members are preferred
+    const Partition * selectGuide(const Partition & partition, RandomStream & gen) const {
+        vector<double> distances;
+        for (auto & member : members) distances.push_back(partitionDistance(partition, member));
+        if (all_of(distances.begin(), distances.end(), [](double distance) { return distance == 0; })) return nullptr;
+
+        discrete_distribution<int> dis(distances.begin(), distances.end());
+        return &members[dis(gen)];
+    }
+};
+
+
+// Walks from start to guide, at every step flipping the differing vertex with the largest gain,
+// and returns the best partition strictly between them. The candidates are kept in a lazy max-heap
+// keyed by gain, so a step costs O(degree log n).
+Partition pathRelinking(const Graph & graph, const Partition & start, const Partition & guide) {
+    TRACE_SCOPE("pathRelinking");
+    int n = graph.n;
+    Partition current = start;
+    GainState state(graph, current);
+
+    // Relink towards whichever of guide and its mirror image is closer
+    int different = 0;
+    for (int v = 1; v <= n; v++) different += start.in_x[v] != guide.in_x[v];
+    bool mirrored = different > n - different;
+
+    vector<char> remaining(n + 1, 0);
+    priority_queue<pair<int,int>> candidates; // (gain, vertex), entries with an outdated gain are skipped
+    for (int v = 1; v <= n; v++) {
+        if ((start.in_x[v] != guide.in_x[v]) != mirrored) {
+            remaining[v] = 1;
+            candidates.push({state.gain[v], v});
+        }
+    }
+    int steps = min(different, n - different);
+
+    vector<int> flips;
+    int best_cut_weight = numeric_limits<int>::min(), best_step = 0;
+
+    // The last step would reach the guide itself
+    for (int step = 1; step < steps; step++) {
+        while (!remaining[candidates.top().second] || candidates.top().first != state.gain[candidates.top().second]) candidates.pop();
+        int v = candidates.top().second;
+        candidates.pop();
+
+        remaining[v] = 0;
+        state.flip(v);
+        flips.push_back(v);
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+            int u = graph.neighbor[i];
+            if (remaining[u]) candidates.push({state.gain[u], u});
+        }
+
+        if (current.cut_weight > best_cut_weight) {
+            best_cut_weight = current.cut_weight;
+            best_step = step;
+        }
+    }
+
+    if (best_step == 0) return start; // start and guide are neighbors, nothing in between
+
+    // Replay the flips up to the best intermediate partition
+    Partition best = start;
+    GainState best_state(graph, best);
+    for (int step = 0; step < best_step; step++) best_state.flip(flips[step]);
+    return best;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+#include <limits>
+
+using namespace std;
+
+// SplitMix64 finalizer
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Counter-based random stream: the k-th number of stream s is a hash of (seed, s, k).
+// Every GRASP iteration gets its own stream, so results do not depend on which thread runs it.
+struct RandomStream {
+    typedef uint64_t result_type;
+
+    uint64_t key;
+    uint64_t counter = 0;
+
+    RandomStream(uint64_t seed, uint64_t stream = 0) : key(mix64(seed ^ mix64(stream))) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return numeric_limits<result_type>::max(); }
+
+    result_type operator()() { return mix64(key + 0xD1B54A32D192ED03ULL * ++counter); }
+};
+
+#endif
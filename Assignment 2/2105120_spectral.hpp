@@ -0,0 +1,251 @@
+#ifndef SPECTRAL_HPP
+#define SPECTRAL_HPP
+
+#include <vector>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_random.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+// Spectral tools on the weighted Laplacian L = D - W. For x in {-1, 1}^n, cut(x) = x^T L x / 4 and
+// x^T L x <= n * lambda_max(L), so max-cut <= n * lambda_max(L) / 4, and the top eigenvector is the
+// relaxed optimal cut. Lanczos only estimates lambda_max, so that value is reported as an estimate. Everything works on the adjacency lists: O(m) per matrix-vector product.
+
+struct SpectralOptions {
+    int lanczos_steps = 64; // Krylov subspace size of one Lanczos cycle
+    int max_cycles = 30; // restarts from the current Ritz vector
+    double tolerance = 1e-6; // relative residual |L y - theta y| / theta to stop at
+};
+
+struct SpectralResult {
+    double lambda_max = 0; // largest Ritz value
+    double residual = 0; // |L y - lambda_max y| for the unit Ritz vector y
+    bool converged = false; // residual reached the tolerance
+    long long upper_bound = 0; // max-cut upper bound that always holds
+    long long estimate = 0; // n * lambda_max / 4 with the Ritz value, not a guaranteed bound
+    vector<double> eigenvector; // 1 indexed
+};
+
+
+void laplacianProduct(const Graph & graph, const vector<double> & x, vector<double> & result) {
+    for (int v = 1; v <= graph.n; v++) {
+        double sum = 0;
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) {
+            sum += graph.neighbor_weight[i] * (x[v] - x[graph.neighbor[i]]);
+        }
+        result[v] = sum;
+    }
+}
+
+double dotProduct(const vector<double> & a, const vector<double> & b) {
+    double sum = 0;
+    for (size_t i = 1; i < a.size(); i++) sum += a[i] * b[i];
+    return sum;
+}
+
+
+// Largest eigenvalue of the symmetric tridiagonal matrix (diagonal a, off-diagonal b) by bisection
+// on Sturm sequence counts
+double largestTridiagonalEigenvalue(const vector<double> & a, const vector<double> & b) {
+    int k = a.size();
+    double low = a[0], high = a[0];
+    for (int i = 0; i < k; i++) {
+        double radius = (i > 0 ? fabs(b[i-1]) : 0) + (i + 1 < k ? fabs(b[i]) : 0);
+        low = min(low, a[i] - radius);
+        high = max(high, a[i] + radius);
+    }
+
+    // Number of eigenvalues smaller than x
+    auto countBelow = [&](double x) {
+        int count = 0;
+        double d = 1;
+        for (int i = 0; i < k; i++) {
+            d = a[i] - x - (i > 0 ? b[i-1] * b[i-1] / d : 0);
+            if (d == 0) d = -1e-300;
+            if (d < 0) count++;
+        }
+        return count;
+    };
+
+    for (int iteration = 0; iteration < 200 && high - low > 1e-13 * max(1.0, fabs(high)); iteration++) {
+        double middle = (low + high) / 2;
+        if (countBelow(middle) < k) low = middle;
+        else high = middle;
+    }
+    return high;
+}
+
+// Eigenvector of the tridiagonal matrix for eigenvalue theta, by inverse iteration
+vector<double> tridiagonalEigenvector(const vector<double> & a, const vector<double> & b, double theta) {
+    int k = a.size();
+    double shift = theta + 1e-10 * max(1.0, fabs(theta));
+    vector<double> z(k, 1.0), c(k), d(k);
+
+    for (int iteration = 0; iteration < 3; iteration++) {
+        // Thomas algorithm for (T - shift I) x = z
+        double pivot = a[0] - shift;
+        if (fabs(pivot) < 1e-300) pivot = 1e-300;
+        c[0] = k > 1 ? b[0] / pivot : 0;
+        d[0] = z[0] / pivot;
+        for (int i = 1; i < k; i++) {
+            pivot = a[i] - shift - b[i-1] * c[i-1];
+            if (fabs(pivot) < 1e-300) pivot = 1e-300;
+            c[i] = i + 1 < k ? b[i] / pivot : 0;
+            d[i] = (z[i] - b[i-1] * d[i-1]) / pivot;
+        }
+        for (int i = k - 2; i >= 0; i--) d[i] -= c[i] * d[i+1];
+
+        double norm = 0;
+        for (double value : d) norm += value * value;
+        norm = sqrt(norm);
+        for (int i = 0; i < k; i++) z[i] = d[i] / norm;
+    }
+    return z;
+}
+
+
+// One Lanczos cycle of at most `steps` steps from the unit vector start. The basis is not stored:
+// a first pass builds the tridiagonal matrix, a second pass repeats the same recurrence to assemble
+// the Ritz vector, so memory stays O(n). Returns the largest Ritz value and overwrites start with its
+// unit Ritz vector.
+double lanczosCycle(const Graph & graph, vector<double> & start, int steps) {
+    int n = graph.n;
+    vector<double> alphas, betas;
+
+    auto run = [&](const vector<double> * coefficients, vector<double> * ritz_vector) {
+        vector<double> previous(n + 1, 0), current = start, next(n + 1, 0);
+        double previous_beta = 0;
+        for (int j = 0; j < steps; j++) {
+            if (ritz_vector != nullptr) {
+                if (j >= (int)coefficients->size()) break;
+                for (int v = 1; v <= n; v++) (*ritz_vector)[v] += (*coefficients)[j] * current[v];
+            }
+
+            laplacianProduct(graph, current, next);
+            for (int v = 1; v <= n; v++) next[v] -= previous_beta * previous[v];
+            double alpha = dotProduct(next, current);
+            for (int v = 1; v <= n; v++) next[v] -= alpha * current[v];
+            double beta = sqrt(dotProduct(next, next));
+
+            if (ritz_vector == nullptr) {
+                alphas.push_back(alpha);
+                if (beta < 1e-12 * max(1.0, fabs(alpha))) break; // invariant subspace found
+                betas.push_back(beta);
+            }
+            if (beta == 0) break;
+
+            for (int v = 1; v <= n; v++) {
+                previous[v] = current[v];
+                current[v] = next[v] / beta;
+            }
+            previous_beta = beta;
+        }
+    };
+
+    run(nullptr, nullptr);
+    betas.resize(alphas.size() - 1);
+
+    double theta = largestTridiagonalEigenvalue(alphas, betas);
+    vector<double> coefficients = tridiagonalEigenvector(alphas, betas, theta);
+
+    vector<double> ritz_vector(n + 1, 0);
+    run(&coefficients, &ritz_vector);
+
+    double norm = sqrt(dotProduct(ritz_vector, ritz_vector));
+    if (norm > 0) {
+        for (int v = 1; v <= n; v++) start[v] = ritz_vector[v] / norm;
+    }
+    return theta;
+}
+
+
+// Restarted Lanczos for the top eigenpair of the Laplacian, and the max-cut estimate n theta / 4.
+// A small residual only puts some eigenvalue near theta, not necessarily the largest one, so the
+// estimate is not a bound. The upper bound is the Gershgorin bound lambda_max <= max_v 2 sum_u |w_uv|,
+// capped by the total positive edge weight.
+SpectralResult spectralAnalysis(const Graph & graph, RandomStream & gen, const SpectralOptions & options = SpectralOptions()) {
+    int n = graph.n;
+    SpectralResult result;
+    result.eigenvector.assign(n + 1, 0);
+
+    long long positive_weight = 0;
+    vector<long long> absolute_degree(n + 1, 0);
+    for (auto & edge : graph.edges) {
+        positive_weight += max(0, edge.weight);
+        absolute_degree[edge.u] += abs((long long)edge.weight);
+        absolute_degree[edge.v] += abs((long long)edge.weight);
+    }
+    result.upper_bound = positive_weight;
+    if (n == 0 || graph.m == 0) return result;
+
+    // n * max_v 2 d_v / 4, exact in integers
+    long long gershgorin_bound = (long long)n * *max_element(absolute_degree.begin(), absolute_degree.end()) / 2;
+    result.upper_bound = min(result.upper_bound, gershgorin_bound);
+
+    uniform_real_distribution<double> dis(-1.0, 1.0);
+    for (int v = 1; v <= n; v++) result.eigenvector[v] = dis(gen);
+    double norm = sqrt(dotProduct(result.eigenvector, result.eigenvector));
+    for (int v = 1; v <= n; v++) result.eigenvector[v] /= norm;
+
+    int steps = max(2, min(n, options.lanczos_steps));
+    vector<double> product(n + 1, 0);
+
+    for (int cycle = 0; cycle < options.max_cycles; cycle++) {
+        result.lambda_max = lanczosCycle(graph, result.eigenvector, steps);
+
+        laplacianProduct(graph, result.eigenvector, product);
+        double residual = 0;
+        for (int v = 1; v <= n; v++) residual += pow(product[v] - result.lambda_max * result.eigenvector[v], 2);
+        result.residual = sqrt(residual);
+
+        result.converged = result.residual <= options.tolerance * max(1.0, fabs(result.lambda_max));
+        if (result.converged) break;
+    }
+
+    result.estimate = llround(n * result.lambda_max / 4.0);
+    return result;
+}
+
+
+// Spectral rounding: sweeps a threshold over the eigenvector entries, moving the vertices to x in
+// decreasing order of their entry and keeping the best of the n + 1 threshold cuts (the sign cut is
+// one of them). The sweep flips every vertex once, O(m + n log n) in total.
+Partition SpectralMaxCut(const Graph & graph, RandomStream & gen, SpectralResult * spectral = nullptr) {
+    TRACE_SCOPE("SpectralMaxCut");
+    int n = graph.n;
+    SpectralResult analysis = spectralAnalysis(graph, gen);
+
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 1);
+    sort(order.begin(), order.end(), [&](int a, int b) { return analysis.eigenvector[a] > analysis.eigenvector[b]; });
+
+    Partition partition;
+    partition.in_x.assign(n + 1, 0);
+    partition.cut_weight = 0;
+    GainState state(graph, partition);
+
+    int best_cut_weight = 0, best_prefix = 0;
+    for (int i = 0; i < n; i++) {
+        state.flip(order[i]);
+        if (partition.cut_weight > best_cut_weight) {
+            best_cut_weight = partition.cut_weight;
+            best_prefix = i + 1;
+        }
+    }
+
+    partition.in_x.assign(n + 1, 0);
+    for (int i = 0; i < best_prefix; i++) partition.in_x[order[i]] = 1;
+    partition.cut_weight = best_cut_weight;
+    checkCutWeight(graph, partition);
+
+    if (spectral != nullptr) *spectral = move(analysis);
+    return partition;
+}
+
+#endif
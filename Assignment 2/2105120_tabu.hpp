@@ -0,0 +1,195 @@
+#ifndef TABU_HPP
+#define TABU_HPP
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_random.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+// Vertices bucketed by flip gain. Every bucket is a doubly linked list, so moving a vertex to another
+// bucket when its gain changes is O(1). Nothing above `top` is non-empty, and top only moves down
+// while looking for the maximum, so finding it is amortized O(1) per move.
+class GainBuckets {
+    int max_gain;
+    vector<int> head, next_, prev_, gain_of;
+    int top;
+
+public:
+    GainBuckets(int n, int max_gain) : max_gain(max_gain), head(2 * max_gain + 1, 0), next_(n + 1, 0), prev_(n + 1, 0), gain_of(n + 1, 0), top(0) {}
+
+    void insert(int v, int gain) {
+        int bucket = gain + max_gain;
+        gain_of[v] = gain;
+        prev_[v] = 0;
+        next_[v] = head[bucket];
+        if (head[bucket]) prev_[head[bucket]] = v;
+        head[bucket] = v;
+        top = max(top, bucket);
+    }
+
+    void remove(int v) {
+        int bucket = gain_of[v] + max_gain;
+        if (prev_[v]) next_[prev_[v]] = next_[v];
+        else head[bucket] = next_[v];
+        if (next_[v]) prev_[next_[v]] = prev_[v];
+    }
+
+    void update(int v, int gain) {
+        if (gain == gain_of[v]) return;
+        remove(v);
+        insert(v, gain);
+    }
+
+    // Highest gain of any vertex, the buckets must not be empty
+    int maxGain() {
+        while (head[top] == 0) top--;
+        return top - max_gain;
+    }
+
+    // Iteration over one bucket: first(gain), then next(v) until 0
+    int first(int gain) const { return head[gain + max_gain]; }
+    int next(int v) const { return next_[v]; }
+    int lowestGain() const { return -max_gain; }
+};
+
+
+int maxAbsoluteGain(const Graph & graph) {
+    int max_gain = 0;
+    for (int v = 1; v <= graph.n; v++) {
+        int total = 0;
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) total += abs(graph.neighbor_weight[i]);
+        max_gain = max(max_gain, total);
+    }
+    return max_gain;
+}
+
+
+struct TabuOptions {
+    long long max_moves = 100000; // move budget, local search moves and perturbation moves
+    double time_limit = 0; // seconds, 0 means no time limit
+    int min_jumps = 0; // perturbation strength L0, 0 means max(1, n / 100)
+    int max_jumps = 0; // strength of the strong perturbation, 0 means n / 10
+    int stagnation_limit = 1000; // local optima without improvement before a strong perturbation
+    double min_directed_probability = 0.75; // P0
+    int min_tenure = 3;
+    int max_tenure = 0; // 0 means max(min_tenure, n / 10)
+};
+
+
+// Breakout local search (tabu search with adaptive perturbation) starting from partition.
+// Steepest descent leads to a local optimum, which is then perturbed by L moves. The moves are
+// directed tabu moves (best non-tabu flip, or a tabu flip that beats the best cut) with probability
+// max(e^(-w / T), P0), where w counts local optima since the last improvement, and random otherwise.
+// L grows by one every time the search returns to the same local optimum. Leaves the best partition
+// found in partition and returns the number of moves made.
+long long BreakoutLocalSearchMaxCut(const Graph & graph, Partition & partition, RandomStream & gen, const TabuOptions & options) {
+    TRACE_SCOPE("BreakoutLocalSearchMaxCut");
+    int n = graph.n;
+    if (n < 2) return 0;
+
+    auto start_time = chrono::steady_clock::now();
+    auto time_is_up = [&]() {
+        return options.time_limit > 0 && chrono::duration<double>(chrono::steady_clock::now() - start_time).count() >= options.time_limit;
+    };
+
+    int min_jumps = options.min_jumps > 0 ? options.min_jumps : max(1, n / 100);
+    int max_jumps = options.max_jumps > 0 ? options.max_jumps : max(min_jumps, n / 10);
+    int max_tenure = options.max_tenure > 0 ? options.max_tenure : max(options.min_tenure, n / 10);
+
+    Partition current = partition;
+    GainState state(graph, current);
+    GainBuckets buckets(n, maxAbsoluteGain(graph));
+    for (int v = 1; v <= n; v++) buckets.insert(v, state.gain[v]);
+
+    vector<long long> tabu_until(n + 1, 0);
+    long long moves = 0;
+    int best_cut_weight = partition.cut_weight;
+
+    auto flip = [&](int v) {
+        state.flip(v);
+        buckets.update(v, state.gain[v]);
+        for (int i = graph.offset[v]; i < graph.offset[v+1]; i++) buckets.update(graph.neighbor[i], state.gain[graph.neighbor[i]]);
+        moves++;
+    };
+
+    // Best non-tabu move, or a tabu move that leads to a new best cut
+    auto directedMove = [&]() {
+        for (int gain = buckets.maxGain(); gain >= buckets.lowestGain(); gain--) {
+            for (int v = buckets.first(gain); v != 0; v = buckets.next(v)) {
+                if (tabu_until[v] <= moves || current.cut_weight + gain > best_cut_weight) return v;
+            }
+        }
+        return (int)(gen() % n) + 1;
+    };
+
+    uniform_int_distribution<int> random_vertex(1, n);
+    uniform_int_distribution<int> random_tenure(options.min_tenure, max(options.min_tenure, max_tenure));
+    uniform_real_distribution<double> coin(0.0, 1.0);
+
+    int jumps = min_jumps;
+    int stagnation = 0;
+    int previous_local_optimum = numeric_limits<int>::min();
+    vector<int> jump_trail; // flips of the current perturbation
+
+    while (moves < options.max_moves && !time_is_up()) {
+        // Steepest descent to a local optimum
+        while (buckets.maxGain() > 0 && moves < options.max_moves) {
+            flip(buckets.first(buckets.maxGain()));
+        }
+
+        if (current.cut_weight > best_cut_weight) {
+            best_cut_weight = current.cut_weight;
+            partition = current;
+            stagnation = 0;
+        } else {
+            stagnation++;
+        }
+
+        // Returning to the same local optimum means the perturbation was too weak
+        if (current.cut_weight == previous_local_optimum) jumps = min(jumps + 1, max_jumps);
+        else jumps = min_jumps;
+        previous_local_optimum = current.cut_weight;
+
+        double directed_probability = max(exp(-(double)stagnation / options.stagnation_limit), options.min_directed_probability);
+        if (stagnation > options.stagnation_limit) {
+            // Strong random perturbation after a long stagnation
+            jumps = max_jumps;
+            directed_probability = 0;
+            stagnation = 0;
+        }
+
+        // Aspiration moves can beat the best. That partition is current after best_prefix jumps, it is
+        // copied once after the perturbation by undoing the later jumps
+        jump_trail.clear();
+        size_t best_prefix = 0;
+        for (int jump = 0; jump < jumps && moves < options.max_moves; jump++) {
+            int v = coin(gen) < directed_probability ? directedMove() : random_vertex(gen);
+            flip(v);
+            tabu_until[v] = moves + random_tenure(gen);
+            jump_trail.push_back(v);
+            if (current.cut_weight > best_cut_weight) {
+                best_cut_weight = current.cut_weight;
+                best_prefix = jump_trail.size();
+            }
+        }
+        if (best_prefix > 0) {
+            partition = current;
+            for (size_t i = best_prefix; i < jump_trail.size(); i++) partition.in_x[jump_trail[i]] ^= 1;
+            partition.cut_weight = best_cut_weight;
+        }
+    }
+
+    // The last descent may have ended on a new best without a perturbation after it
+    if (current.cut_weight > best_cut_weight) partition = current;
+    checkCutWeight(graph, partition);
+    return moves;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TIMING_HPP
+#define TIMING_HPP
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+class Stopwatch {
+    chrono::steady_clock::time_point start;
+
+public:
+    Stopwatch() : start(chrono::steady_clock::now()) {}
+
+    double elapsed() const {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+};
+
+
+// q-th percentile (0 <= q <= 100) with linear interpolation between the closest ranks
+double percentile(vector<double> values, double q) {
+    if (values.empty()) return 0.0;
+    sort(values.begin(), values.end());
+    double rank = q / 100.0 * (values.size() - 1);
+    size_t lower = (size_t)floor(rank);
+    size_t upper = min(lower + 1, values.size() - 1);
+    return values[lower] + (rank - lower) * (values[upper] - values[lower]);
+}
+
+#endif
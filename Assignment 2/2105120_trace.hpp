@@ -0,0 +1,154 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// Optional instrumentation of the hot paths: event counters and scoped timers exported as Chrome
+// trace-event JSON (chrome://tracing, Perfetto). Compiled in with -DMAXCUT_TRACE, otherwise
+// TRACE_COUNT and TRACE_SCOPE expand to nothing and their arguments are not evaluated.
+
+enum TraceCounter {
+    TRACE_FLIPS,              // GainState flips
+    TRACE_GAIN_UPDATES,       // gains recomputed or updated by GainState
+    TRACE_GAIN_EVALUATIONS,   // gains examined by the local search sweeps
+    TRACE_SWEEPS,             // local search sweeps over all vertices
+    TRACE_CONSTRUCTION_STEPS, // vertices placed by the constructive algorithms
+    TRACE_RCL_BUILDS,         // restricted candidate lists built by the semi-greedy construction
+    TRACE_RCL_CANDIDATES,     // total size of those lists
+    TRACE_COUNTER_COUNT
+};
+
+const char * const TRACE_COUNTER_NAMES[TRACE_COUNTER_COUNT] = {
+    "flips", "gain_updates", "gain_evaluations", "sweeps", "construction_steps", "rcl_builds", "rcl_candidates"
+};
+
+#ifdef MAXCUT_TRACE
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+struct TraceEvent {
+    string name;
+    double start, duration; // microseconds since the tracer started
+    int thread;
+};
+
+// Everything one thread recorded. Threads never share a buffer, so recording takes no lock; a buffer
+// is merged into the tracer when its thread exits or when the totals are read.
+struct TraceBuffer {
+    int thread;
+    long long counters[TRACE_COUNTER_COUNT] = {};
+    vector<TraceEvent> events;
+
+    TraceBuffer();
+    ~TraceBuffer();
+};
+
+class Tracer {
+    mutex lock;
+    long long counters[TRACE_COUNTER_COUNT] = {};
+    vector<TraceEvent> events;
+    atomic<int> next_thread{0};
+    chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+
+public:
+    static Tracer & instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static TraceBuffer & local() {
+        thread_local TraceBuffer buffer;
+        return buffer;
+    }
+
+    int newThreadId() { return next_thread++; }
+
+    double now() const {
+        return chrono::duration<double, micro>(chrono::steady_clock::now() - origin).count();
+    }
+
+    void merge(TraceBuffer & buffer) {
+        lock_guard<mutex> guard(lock);
+        for (int c = 0; c < TRACE_COUNTER_COUNT; c++) counters[c] += buffer.counters[c];
+        events.insert(events.end(), buffer.events.begin(), buffer.events.end());
+        fill(buffer.counters, buffer.counters + TRACE_COUNTER_COUNT, 0);
+        buffer.events.clear();
+    }
+
+    // Totals of every thread that has exited and of the calling thread, read after the parallel work
+    long long total(TraceCounter counter) {
+        merge(local());
+        lock_guard<mutex> guard(lock);
+        return counters[counter];
+    }
+
+    // Scoped timers become complete ("X") events, the counter totals one counter ("C") event at the end
+    void writeChromeTrace(const string & path) {
+        merge(local());
+        lock_guard<mutex> guard(lock);
+        ofstream json(path);
+        if (!json) throw runtime_error("cannot write " + path);
+
+        auto escape = [](const string & text) {
+            string escaped;
+            for (char c : text) {
+                if (c == '"' || c == '\\') escaped += '\\';
+                escaped += c;
+            }
+            return escaped;
+        };
+
+        json << fixed << setprecision(3);
+        json << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        double end = 0;
+        for (auto & event : events) {
+            json << "{\"name\": \"" << escape(event.name) << "\", \"cat\": \"maxcut\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+                 << ", \"ts\": " << event.start << ", \"dur\": " << event.duration << "},\n";
+            end = max(end, event.start + event.duration);
+        }
+        json << "{\"name\": \"counters\", \"ph\": \"C\", \"pid\": 1, \"tid\": 0, \"ts\": " << end << ", \"args\": {";
+        for (int c = 0; c < TRACE_COUNTER_COUNT; c++) {
+            json << (c ? ", " : "") << "\"" << TRACE_COUNTER_NAMES[c] << "\": " << counters[c];
+        }
+        json << "}}\n]}\n";
+    }
+};
+
+inline TraceBuffer::TraceBuffer() : thread(Tracer::instance().newThreadId()) {}
+inline TraceBuffer::~TraceBuffer() { Tracer::instance().merge(*this); }
+
+
+// Records the lifetime of the enclosing scope as one event
+class TraceScope {
+    string name;
+    double start;
+
+public:
+    TraceScope(string name) : name(move(name)), start(Tracer::instance().now()) {}
+
+    ~TraceScope() {
+        TraceBuffer & buffer = Tracer::local();
+        buffer.events.push_back({move(name), start, Tracer::instance().now() - start, buffer.thread});
+    }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_COUNT(counter, amount) (Tracer::local().counters[counter] += (amount))
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+#else
+
+#define TRACE_COUNT(counter, amount) ((void)0)
+#define TRACE_SCOPE(name) ((void)0)
+
+#endif
+
+#endif
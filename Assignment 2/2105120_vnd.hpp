@@ -0,0 +1,116 @@
+#ifndef VND_HPP
+#define VND_HPP
+
+#include <vector>
+#include <cassert>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include "2105120_graph.hpp"
+#include "2105120_partition.hpp"
+#include "2105120_random.hpp"
+#include "2105120_trace.hpp"
+
+using namespace std;
+
+struct VNDOptions {
+    bool two_flip = true; // escalate to the 2-flip neighborhood at 1-flip local optima
+    int shakes = 0; // shaking rounds after the first descent
+    int max_shake_strength = 0; // vertices flipped by the strongest shake, 0 means max(2, n / 50)
+};
+
+
+// Variable neighborhood descent.
+// N1 flips one vertex, first improvement over a random vertex order. N2 flips the two endpoints of an
+// edge (u, v) of weight w, whose gain is gain[u] + gain[v] - 2w when u and v are on the same side and
+// gain[u] + gain[v] + 2w otherwise. A pair of non-adjacent vertices gains gain[u] + gain[v], which is
+// never positive at an N1 optimum, so N2 only has to scan the edges. Any N2 improvement restarts N1.
+//
+// With shakes, the local optimum is perturbed by k random flips (k cycling from 1 to the maximum
+// strength) and descended again. A worse result is undone through the log of flips.
+// Leaves the best partition in partition and returns the number of improving moves.
+int VariableNeighborhoodDescent(const Graph & graph, Partition & partition, RandomStream & gen, const VNDOptions & options = VNDOptions()) {
+    TRACE_SCOPE("VariableNeighborhoodDescent");
+    int n = graph.n;
+    GainState state(graph, partition);
+    int improving_moves = 0;
+
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 1);
+    vector<int> edge_order(graph.m);
+    iota(edge_order.begin(), edge_order.end(), 0);
+
+    vector<int> trail; // flips since the last accepted partition
+    auto flip = [&](int v) {
+        state.flip(v);
+        trail.push_back(v);
+    };
+
+    auto oneFlipDescent = [&]() {
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            shuffle(order.begin(), order.end(), gen);
+            for (int v : order) {
+                if (state.gain[v] > 0) {
+                    flip(v);
+                    improving_moves++;
+                    improved = true;
+                }
+            }
+        }
+    };
+
+    // Returns true if an improving pair was flipped
+    auto twoFlipMove = [&]() {
+        shuffle(edge_order.begin(), edge_order.end(), gen);
+        for (int e : edge_order) {
+            const Edge & edge = graph.edges[e];
+            bool same_side = partition.in_x[edge.u] == partition.in_x[edge.v];
+            int pair_gain = state.gain[edge.u] + state.gain[edge.v] + (same_side ? -2 : 2) * edge.weight;
+            if (pair_gain > 0) {
+                int cut_weight = partition.cut_weight;
+                flip(edge.u);
+                flip(edge.v);
+                assert(partition.cut_weight == cut_weight + pair_gain); // fails on a graph that is not simple
+                improving_moves++;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto descend = [&]() {
+        do {
+            oneFlipDescent();
+        } while (options.two_flip && twoFlipMove());
+    };
+
+    descend();
+    trail.clear();
+
+    int max_strength = options.max_shake_strength > 0 ? options.max_shake_strength : max(2, n / 50);
+    uniform_int_distribution<int> random_vertex(1, max(1, n));
+
+    for (int shake = 0, strength = 1; shake < options.shakes && n > 1; shake++) {
+        int accepted_cut_weight = partition.cut_weight;
+        for (int k = 0; k < strength; k++) flip(random_vertex(gen));
+        descend();
+
+        if (partition.cut_weight > accepted_cut_weight) {
+            strength = 1; // improvement, go back to the smallest shake
+        } else {
+            while (!trail.empty()) {
+                state.flip(trail.back());
+                trail.pop_back();
+            }
+            strength = strength % max_strength + 1;
+        }
+        trail.clear();
+    }
+
+    checkCutWeight(graph, partition);
+    return improving_moves;
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <numeric>
 #include <random>
 #include <unordered_map>
 #include "decision_tree.hpp"
@@ -23,52 +24,86 @@ string trim(const string & str)
     return str.substr(first, last - first + 1);
 }
 
-void read_adult_file(vector<DataPoint> & data, vector<string> & attributes, string & class_label_name, unordered_map<string, AttributeType> & attribute_value_types)
+// Id of value in a dictionary, a new value gets the next id
+int get_value_id(const string & value, unordered_map<string, int> & ids, vector<string> & names)
+{
+    auto it = ids.find(value);
+    if(it != ids.end()) return it->second;
+    ids.emplace(value, names.size());
+    names.push_back(value);
+    return names.size() - 1;
+}
+
+// Appends rows to the columns of a dataset whose attributes and attribute types are set.
+// Numerical values are parsed once here, categorical values and class labels get their ids here.
+class ColumnEncoder
+{
+    Dataset & data;
+    vector<unordered_map<string, int>> value_ids; // per attribute
+    unordered_map<string, int> class_ids;
+
+    public:
+    ColumnEncoder(Dataset & data): data(data), value_ids(data.attributes.size())
+    {
+        data.numeric_values.resize(data.attributes.size());
+        data.categorical_values.resize(data.attributes.size());
+        data.value_names.resize(data.attributes.size());
+    }
+
+    // values has one entry per attribute, missing trailing values are empty
+    void add_row(const vector<string> & values, const string & class_label)
+    {
+        for(size_t i = 0; i < data.attributes.size(); i++)
+        {
+            string value = i < values.size() ? values[i] : "";
+            if(data.attribute_types[i] == NUMERICAL)
+            {
+                double number = numeric_limits<double>::quiet_NaN();
+                try { number = stod(value); }
+                catch (...) {} // not a number, kept as NaN
+                data.numeric_values[i].push_back(number);
+            }
+            else
+            {
+                data.categorical_values[i].push_back(get_value_id(value, value_ids[i], data.value_names[i]));
+            }
+        }
+        data.class_labels.push_back(get_value_id(class_label, class_ids, data.class_names));
+    }
+};
+
+void read_adult_file(Dataset & data)
 {
     ifstream input_file(ADULT_FILE);
     string line, word;
     for(int i = 0; i < 14; i++) // Read the first line for attributes
     {
-        attributes.push_back("Attribute" + to_string(i + 1));
+        data.attributes.push_back("Attribute" + to_string(i + 1));
     }
-    class_label_name = "Class";
-    int attribute_size = attributes.size();
-    attribute_value_types["Attribute1"] = NUMERICAL;
-    attribute_value_types["Attribute2"] = CATEGORICAL;
-    attribute_value_types["Attribute3"] = NUMERICAL;
-    attribute_value_types["Attribute4"] = CATEGORICAL;
-    attribute_value_types["Attribute5"] = NUMERICAL;
-    attribute_value_types["Attribute6"] = CATEGORICAL;
-    attribute_value_types["Attribute7"] = CATEGORICAL;
-    attribute_value_types["Attribute8"] = CATEGORICAL;
-    attribute_value_types["Attribute9"] = CATEGORICAL;
-    attribute_value_types["Attribute10"] = CATEGORICAL;
-    attribute_value_types["Attribute11"] = NUMERICAL;
-    attribute_value_types["Attribute12"] = NUMERICAL;
-    attribute_value_types["Attribute13"] = NUMERICAL;
-    attribute_value_types["Attribute14"] = CATEGORICAL;
+    data.class_label_name = "Class";
+    size_t attribute_size = data.attributes.size();
+    data.attribute_types = {NUMERICAL, CATEGORICAL, NUMERICAL, CATEGORICAL, NUMERICAL, CATEGORICAL, CATEGORICAL,
+                            CATEGORICAL, CATEGORICAL, CATEGORICAL, NUMERICAL, NUMERICAL, NUMERICAL, CATEGORICAL};
+    ColumnEncoder encoder(data);
+    vector<string> values;
     while(getline(input_file, line))
     {
         if(line.empty()) continue;
         stringstream ss(line);
-        DataPoint point;
-        int index = 0;
-        while(getline(ss, word, ',') && index < attribute_size)
+        values.clear();
+        while(values.size() < attribute_size && getline(ss, word, ','))
         {
-            word = trim(word);
-            point.attribute_values[attributes[index]] = word;
-            index++;
+            values.push_back(trim(word));
         }
+        word.clear();
         getline(ss, word, ','); // Read the class label
-        point.class_label = trim(word);
-
-        data.push_back(point);
+        encoder.add_row(values, trim(word));
     }
     input_file.close();
 }
 
 
-void read_iris_file(vector<DataPoint> & data, vector<string> & attributes, string & class_label_name, unordered_map<string, AttributeType> & attribute_value_types)
+void read_iris_file(Dataset & data)
 {
 
     ifstream input_file(IRIS_FILE);
@@ -81,62 +116,101 @@ void read_iris_file(vector<DataPoint> & data, vector<string> & attributes, strin
         while(getline(ss, word, ','))
         {
             word = trim(word);
-            attributes.push_back(word);
+            data.attributes.push_back(word);
         }
-        class_label_name = attributes.back();
-        attributes.pop_back();
-    }
-    int attribute_size = attributes.size();
-    for(int i = 0; i < attribute_size; i++)
-    {
-        attribute_value_types[attributes[i]] = NUMERICAL; // Assuming all attributes are of type string for simplicity
+        data.class_label_name = data.attributes.back();
+        data.attributes.pop_back();
     }
+    size_t attribute_size = data.attributes.size();
+    data.attribute_types.assign(attribute_size, NUMERICAL);
+    ColumnEncoder encoder(data);
+    vector<string> values;
     while(getline(input_file, line))
     {
         if(line.empty()) continue;
         stringstream ss(line);
         // Skip the first column (ID)
         getline(ss, word, ','); // Skip the first column (ID)
-        DataPoint point;
-        int index = 0;
-        while(getline(ss, word, ',') && index < attribute_size)
+        values.clear();
+        while(values.size() < attribute_size && getline(ss, word, ','))
         {
-            word = trim(word);
-            point.attribute_values[attributes[index]] = word;
-            index++;
+            values.push_back(trim(word));
         }
+        word.clear();
         getline(ss, word, ','); // Read the class label
-        point.class_label = trim(word);
-
-        data.push_back(point);
+        encoder.add_row(values, trim(word));
     }
     input_file.close();
 }
 
-void print_data(const vector<DataPoint> & data, const vector<string> & attributes)
+// Histogram mode: quantizes every numerical column into at most HISTOGRAM_BINS - 1 bins holding about
+// as many rows each, or a bin per distinct value when there are few enough. A value never spans two bins.
+// Thresholds lie halfway between the last value of a bin and the first value of the next one.
+void quantize_numeric_columns(Dataset & data)
+{
+    const int max_bins = HISTOGRAM_BINS - 1;
+    data.bin_values.assign(data.attributes.size(), {});
+    data.bin_thresholds.assign(data.attributes.size(), {});
+    for(size_t attribute = 0; attribute < data.attributes.size(); attribute++)
+    {
+        if(data.attribute_types[attribute] != NUMERICAL) continue;
+        const vector<double> & column = data.numeric_values[attribute];
+        vector<double> values;
+        for(double value : column)
+        {
+            if(!isnan(value)) values.push_back(value);
+        }
+        sort(values.begin(), values.end());
+        size_t distinct_values = values.empty() ? 0 : 1;
+        for(size_t i = 1; i < values.size(); i++) distinct_values += values[i] != values[i-1];
+
+        vector<double> & thresholds = data.bin_thresholds[attribute];
+        size_t count = values.size();
+        for(size_t i = 1; i < count; i++)
+        {
+            if(values[i] == values[i-1]) continue;
+            // i starts a new value, close the bin before it once the bin has reached its share of the rows
+            bool close = distinct_values <= (size_t)max_bins || i * max_bins >= (thresholds.size() + 1) * count;
+            if(close) thresholds.push_back((values[i-1] + values[i]) / 2.0);
+        }
+
+        vector<uint8_t> & bins = data.bin_values[attribute];
+        bins.resize(column.size());
+        for(size_t row = 0; row < column.size(); row++)
+        {
+            if(isnan(column[row])) bins[row] = MISSING_BIN;
+            else bins[row] = upper_bound(thresholds.begin(), thresholds.end(), column[row]) - thresholds.begin();
+        }
+    }
+}
+
+void print_data(const Dataset & data)
 {
-    for(const auto & attr : attributes)
+    for(const auto & attr : data.attributes)
     {
         cout << attr << " ";
     }
     cout << endl;
 
-    for(const auto & point : data)
+    for(int row = 0; row < data.size(); row++)
     {
-        for(const auto & attr : attributes)
+        for(size_t i = 0; i < data.attributes.size(); i++)
         {
-            cout << point.attribute_values.at(attr) << " ";
+            if(data.attribute_types[i] == NUMERICAL) cout << data.numeric_values[i][row] << " ";
+            else cout << data.value_names[i][data.categorical_values[i][row]] << " ";
         }
-        cout << point.class_label << endl;
+        cout << data.class_names[data.class_labels[row]] << endl;
     }
 }
 
-void split_data(const vector<DataPoint> & data, vector<DataPoint> & training_data, vector<DataPoint> & test_data)
+// Splits the rows of data 80/20 into training and test rows
+void split_data(const Dataset & data, vector<int> & training_rows, vector<int> & test_rows)
 {
-    vector<DataPoint> shuffled_data = data;
-    std::shuffle(shuffled_data.begin(), shuffled_data.end(), std::default_random_engine(std::random_device{}()));
-    size_t train_size = static_cast<size_t>(shuffled_data.size() * 0.8);
+    vector<int> shuffled_rows(data.size());
+    iota(shuffled_rows.begin(), shuffled_rows.end(), 0);
+    std::shuffle(shuffled_rows.begin(), shuffled_rows.end(), std::default_random_engine(std::random_device{}()));
+    size_t train_size = static_cast<size_t>(shuffled_rows.size() * 0.8);
 
-    training_data.assign(shuffled_data.begin(), shuffled_data.begin() + train_size);
-    test_data.assign(shuffled_data.begin() + train_size, shuffled_data.end());
+    training_rows.assign(shuffled_rows.begin(), shuffled_rows.begin() + train_size);
+    test_rows.assign(shuffled_rows.begin() + train_size, shuffled_rows.end());
 }
\ No newline at end of file
@@ -2,23 +2,82 @@
 #define decision_tree_hpp
 
 #include "node.hpp"
+#include "thread_pool.hpp"
 #include <iostream>
+#include <string>
 #include <vector>
+#include <cstdint>
 #include <cmath>
-#include <unordered_set>
 #include <algorithm>
-#include <cmath>
 #include <limits>
+#include <memory>
 using namespace std;
 
 enum AttributeType {
-    NUMERICAL, 
-    CATEGORICAL 
+    NUMERICAL,
+    CATEGORICAL
 };
-struct DataPoint
+
+// histogram mode: numerical values are quantized into bins 0 .. HISTOGRAM_BINS - 2, the last bin holds values that are not numbers
+const int HISTOGRAM_BINS = 256;
+const int MISSING_BIN = HISTOGRAM_BINS - 1;
+
+// attributes are scored in parallel on nodes with at least this many rows per thread
+const int PARALLEL_MIN_ROWS = 4096;
+
+// Columnar dataset: one contiguous column per attribute, categorical values and class labels are
+// dictionary encoded as ids. A subset of the data (a node of the tree, the training data) is a list of row indices.
+struct Dataset
 {
-    string class_label;
-    unordered_map<string, string> attribute_values; // map of attribute names to their values
+    vector<string> attributes; // attribute names in column order
+    vector<AttributeType> attribute_types;
+    vector<vector<double>> numeric_values; // column per numerical attribute (empty for categorical ones), NaN where the value is not a number
+    vector<vector<int>> categorical_values; // column of value ids per categorical attribute (empty for numerical ones)
+    vector<vector<string>> value_names; // value of every id, per categorical attribute
+    string class_label_name;
+    vector<int> class_labels; // class id per row
+    vector<string> class_names;
+
+    // histogram mode, filled by quantize_numeric_columns
+    vector<vector<uint8_t>> bin_values; // bin of every row per numerical attribute
+    vector<vector<double>> bin_thresholds; // per numerical attribute, values below bin_thresholds[b] are in bins 0 .. b
+
+    int size() const { return class_labels.size(); }
+    int class_count() const { return class_names.size(); }
+};
+
+// Rows [begin, end) of a row index array, iterable like a vector
+struct RowRange
+{
+    const int * first = nullptr;
+    const int * last = nullptr;
+
+    const int * begin() const { return first; }
+    const int * end() const { return last; }
+    int size() const { return last - first; }
+    bool empty() const { return first == last; }
+    int operator[](int i) const { return first[i]; }
+};
+
+// A tree node is a range of positions in the row arrays of the tree: the training rows, and like
+// SLIQ/SPRINT the training rows sorted by value per numerical attribute (values that are not numbers
+// last). The columns are sorted once when training starts, and a split partitions the range of every
+// array stably and in place into child ranges, so the split search below the root is a linear scan.
+// In histogram mode a node keeps class counts per bin (or categorical value) instead. Only the smaller
+// children count their rows, the largest child takes the histograms of its parent minus its siblings.
+struct NodeRows
+{
+    int begin = 0, end = 0; // positions in the row arrays
+    vector<vector<int>> histograms; // histogram mode: per attribute, class counts per bin or value id (bin * class_count + class)
+
+    int size() const { return end - begin; }
+};
+
+struct SplitPoint
+{
+    double value = 0.0; // values below go left
+    double gain = 0.0;
+    int left_size = 0, right_size = 0; // rows with a numeric value on either side
 };
 
 class DecisionTree
@@ -26,14 +85,25 @@ class DecisionTree
     Node * root;
     int max_depth;
     bool pruning_enabled = true; // whether to enable pruning or not
-    unordered_map<string, AttributeType> attribute_value_types;
+    bool histogram_mode; // split search over the bins of quantized numerical attributes
+    int threads; // threads scoring the attributes of large nodes
+    unique_ptr<ThreadPool> pool; // while training, if threads > 1
+    const Dataset * dataset = nullptr; // training data, its dictionaries name the values in the tree
     // Function pointer for attribute selection strategy
-    double (DecisionTree::*attribute_selection_strategy)(const vector<DataPoint> &, const string &);
-
-    Node * build_tree(const vector<DataPoint> & data, const vector<string> & attributes, int depth);
-    string get_best_attribute(const vector<DataPoint> & data, const vector<string> & attributes);
-    string get_majority_class(const vector<DataPoint> & data);
-    bool is_pure_node(const vector<DataPoint> & data);
+    double (DecisionTree::*attribute_selection_strategy)(const NodeRows &, int);
+    vector<int> training_rows; // every node owns a range of it
+    vector<vector<int>> sorted_rows; // per numerical attribute, the training rows in ascending value order within every node range (empty in histogram mode)
+    vector<int> partition_buffer;
+    vector<int> row_child; // child of every row of the node being split, -1 for rows that are dropped
+
+    RowRange node_rows(const NodeRows & node);
+    RowRange sorted_node_rows(const NodeRows & node, int attribute); // without the values that are not numbers
+    Node * build_tree(NodeRows & node, const vector<int> & attributes, int depth);
+    vector<NodeRows> partition_node(NodeRows & node, int child_count, const vector<int> & attributes);
+    void count_histograms(RowRange rows, const vector<int> & attributes, vector<vector<int>> & histograms, int sign);
+    int get_best_attribute(const NodeRows & node, const vector<int> & attributes);
+    int get_majority_class(RowRange rows);
+    bool is_pure_node(RowRange rows);
 
 
     void print_tree(Node * node, int depth);
@@ -41,16 +111,23 @@ class DecisionTree
     int get_tree_size_helper(Node * node);
 
     // selection criteria
-    double entropy(const vector<DataPoint> & data);
-    double information_gain(const vector<DataPoint> & data, const string & attribute);
-    double information_gain_ratio(const vector<DataPoint> & data, const string & attribute);
-    double normalized_weighted_information_gain(const vector<DataPoint> & data, const string & attribute);
+    double entropy(RowRange rows);
+    double information_gain(const NodeRows & node, int attribute);
+    double information_gain_ratio(const NodeRows & node, int attribute);
+    double normalized_weighted_information_gain(const NodeRows & node, int attribute);
+
+    // class counts of the rows, and per value id of a categorical attribute (value * class_count + class)
+    vector<int> count_classes(RowRange rows);
+    vector<int> count_value_classes(const NodeRows & node, int attribute);
+    int count_unique_values(const NodeRows & node, int attribute);
 
     // for numeric attributes
-    double partition_entropy(const unordered_map<string, int> & partition, double total_size);
-    pair<double, double> get_best_split_value_and_gain(const vector<DataPoint> & data, const string & attribute);
+    double partition_entropy(const int * class_counts, double total_size);
+    SplitPoint get_best_split_value_and_gain(const NodeRows & node, int attribute);
+    SplitPoint get_best_split_from_histogram(const NodeRows & node, int attribute);
     public:
-    DecisionTree(int max_depth, string selection_strategy, unordered_map<string, AttributeType> attribute_value_types): root(nullptr), max_depth(max_depth) {
+    // histogram mode needs a dataset quantized by quantize_numeric_columns
+    DecisionTree(int max_depth, string selection_strategy, bool histogram_mode = false, int threads = 1): root(nullptr), max_depth(max_depth), histogram_mode(histogram_mode), threads(max(1, threads)) {
         if(selection_strategy == "ig") attribute_selection_strategy = &DecisionTree::information_gain;
         else if(selection_strategy == "igr") attribute_selection_strategy = &DecisionTree::information_gain_ratio;
         else if(selection_strategy == "nwig") attribute_selection_strategy = &DecisionTree::normalized_weighted_information_gain;
@@ -59,33 +136,71 @@ class DecisionTree
             cerr << "Error: Unsupported attribute selection strategy." << endl;
             attribute_selection_strategy = nullptr; // default to nullptr if unsupported
         }
-        if(max_depth == 0) 
+        if(max_depth == 0)
         {
             pruning_enabled = false;
         }
-        this->attribute_value_types = attribute_value_types; // Initialize attribute value types
     }
-    ~DecisionTree() 
+    ~DecisionTree()
     {
         delete root; // delete the root node, which recursively deletes all child nodes
     }
 
-    bool train(const vector<DataPoint> & data, const vector<string> & attrributes);
-    string predict(const DataPoint & point);
+    // the tree keeps a pointer to data, which must outlive it
+    bool train(const Dataset & data, const vector<int> & rows);
+    int predict(const Dataset & data, int row); // class id, -1 if the row cannot be classified
     void print();
     int get_tree_depth();
     int get_tree_size();
 };
 
-bool DecisionTree::train(const vector<DataPoint> & data, const vector<string> & attributes)
+bool DecisionTree::train(const Dataset & data, const vector<int> & rows)
 {
-    if(data.empty() || attributes.empty())
+    if(rows.empty() || data.attributes.empty())
     {
         cerr << "Error: Training data or attributes cannot be empty." << endl;
         return false;
     }
 
-    root = build_tree(data, attributes, 0);
+    if(histogram_mode && data.bin_values.size() != data.attributes.size())
+    {
+        cerr << "Error: Histogram mode needs quantized numerical attributes." << endl;
+        return false;
+    }
+
+    dataset = &data;
+    vector<int> attributes(data.attributes.size());
+    for(int i = 0; i < (int)attributes.size(); i++) attributes[i] = i;
+
+    training_rows = rows;
+    partition_buffer.assign(rows.size(), 0);
+    row_child.assign(data.size(), -1);
+    sorted_rows.assign(data.attributes.size(), {});
+    NodeRows node;
+    node.end = rows.size();
+    if(histogram_mode)
+    {
+        node.histograms.resize(data.attributes.size());
+        count_histograms(node_rows(node), attributes, node.histograms, 1);
+    }
+    else
+    {
+        // presort the numerical columns, values that are not numbers go last and rows with equal values stay in training order
+        for(int attribute : attributes)
+        {
+            if(data.attribute_types[attribute] != NUMERICAL) continue;
+            const vector<double> & column = data.numeric_values[attribute];
+            sorted_rows[attribute] = rows;
+            stable_sort(sorted_rows[attribute].begin(), sorted_rows[attribute].end(), [&](int a, int b) {
+                return !isnan(column[a]) && (isnan(column[b]) || column[a] < column[b]);
+            });
+        }
+    }
+
+    delete root;
+    if(threads > 1) pool.reset(new ThreadPool(threads));
+    root = build_tree(node, attributes, 0);
+    pool.reset();
     if(root == nullptr)
     {
         cerr << "Error: Failed to build the decision tree." << endl;
@@ -94,191 +209,244 @@ bool DecisionTree::train(const vector<DataPoint> & data, const vector<string> &
     return true; // Successfully built the tree
 }
 
-Node * DecisionTree::build_tree(const vector<DataPoint> & data, const vector<string> & attributes, int depth)
+RowRange DecisionTree::node_rows(const NodeRows & node)
 {
-    if(data.empty())
+    return {training_rows.data() + node.begin, training_rows.data() + node.end};
+}
+
+RowRange DecisionTree::sorted_node_rows(const NodeRows & node, int attribute)
+{
+    const vector<double> & column = dataset->numeric_values[attribute];
+    const int * first = sorted_rows[attribute].data() + node.begin;
+    const int * last = sorted_rows[attribute].data() + node.end;
+    while(last > first && isnan(column[last[-1]])) last--;
+    return {first, last};
+}
+
+Node * DecisionTree::build_tree(NodeRows & node_range, const vector<int> & attributes, int depth)
+{
+    RowRange rows = node_rows(node_range);
+    if(rows.empty())
     {
         return nullptr; // No data to build the tree
     }
     if(attributes.empty())
     {
-        string majority_class_label = get_majority_class(data);
-        return new Node(true, "", majority_class_label, depth);
+        return new Node(true, -1, get_majority_class(rows), depth);
     }
     if(pruning_enabled && depth == this->max_depth) // maximum depth reached
     {
-        string majority_class_label = get_majority_class(data);
-        return new Node(true, "", majority_class_label, depth);
+        return new Node(true, -1, get_majority_class(rows), depth);
     }
     // Check if all data points belong to the same class,i.e. pure node
-    bool is_pure = is_pure_node(data);
-    if(is_pure)
+    if(is_pure_node(rows))
     {
-        return new Node(true, "", data[0].class_label, depth);
+        return new Node(true, -1, dataset->class_labels[rows[0]], depth);
     }
 
-    string best_attribute = get_best_attribute(data, attributes);
-    if(best_attribute.empty()) // no valid attribute found, return majority class
+    int best_attribute = get_best_attribute(node_range, attributes);
+    if(best_attribute < 0) // no valid attribute found, return majority class
     {
-        string majority_class_label = get_majority_class(data);
-        return new Node(true, "", majority_class_label, depth);
+        return new Node(true, -1, get_majority_class(rows), depth);
     }
 
-    Node * node = new Node(false, best_attribute, "", depth);
-
-    if (attribute_value_types[best_attribute] == NUMERICAL)
+    vector<int> remaining_attributes;
+    for(int attribute : attributes)
     {
-        auto [split_value, split_gain] = get_best_split_value_and_gain(data, best_attribute);
-
-        if (split_gain <= 1e-10) // if gain is too small, negligible, return majority class
+        if(attribute != best_attribute)
         {
-            string majority_class_label = get_majority_class(data);
-            return new Node(true, "", majority_class_label, depth);
+            remaining_attributes.push_back(attribute);
         }
+    }
 
-        vector<DataPoint> left, right;
-        for (const auto & point : data)
+    if (dataset->attribute_types[best_attribute] == NUMERICAL)
+    {
+        SplitPoint split = get_best_split_value_and_gain(node_range, best_attribute);
+        double split_value = split.value;
+
+        if (split.gain <= 1e-10) // if gain is too small, negligible, return majority class
         {
-            try
-            {
-                double attribute_value = stod(point.attribute_values.at(best_attribute));
-                (attribute_value < split_value ? left : right).push_back(point);
-            }
-            catch (...) {} // skip points with invalid numeric values
+            return new Node(true, -1, get_majority_class(rows), depth);
         }
 
-        if (left.empty() || right.empty())
+        const vector<double> & column = dataset->numeric_values[best_attribute];
+        for (int row : rows)
         {
-            string majority_class = get_majority_class(data);
-            return new Node(true, "", majority_class, depth);
+            if (isnan(column[row])) row_child[row] = -1; // skip points with invalid numeric values
+            else row_child[row] = column[row] < split_value ? 0 : 1;
         }
+        int majority_class = get_majority_class(rows);
+        vector<NodeRows> children = partition_node(node_range, 2, remaining_attributes);
 
-        vector<string> remaining_attributes;
-        for(const auto & attr : attributes)
+        if (children[0].size() == 0 || children[1].size() == 0)
         {
-            if(attr != best_attribute)
-            {
-                remaining_attributes.push_back(attr);
-            }
+            return new Node(true, -1, majority_class, depth);
         }
 
-        string left_child = "<"  + to_string(split_value);
-        string right_child = ">=" + to_string(split_value);
-
-        node->children[left_child]  = build_tree(left , remaining_attributes, depth + 1);
-        node->children[right_child]  = build_tree(right, remaining_attributes, depth + 1);
+        Node * node = new Node(false, best_attribute, -1, depth);
+        node->split_value = split_value;
+        node->children.push_back(build_tree(children[0], remaining_attributes, depth + 1));
+        node->children.push_back(build_tree(children[1], remaining_attributes, depth + 1));
         return node;
     }
 
-    // categorical attribute
-    unordered_set<string> attribute_values;
-    for(const auto & point : data)
+    // categorical attribute, one child per value seen in the rows
+    const vector<int> & column = dataset->categorical_values[best_attribute];
+    for(int row : rows)
     {
-        attribute_values.insert(point.attribute_values.at(best_attribute));
+        row_child[row] = column[row];
     }
-    vector<string> remaining_attributes;
-    for(const auto & attr : attributes)
+    vector<NodeRows> children = partition_node(node_range, dataset->value_names[best_attribute].size(), remaining_attributes);
+    Node * node = new Node(false, best_attribute, -1, depth);
+    node->children.resize(children.size(), nullptr);
+    for(size_t value = 0; value < children.size(); value++)
     {
-        if(attr != best_attribute)
+        if(children[value].size() > 0)
         {
-            remaining_attributes.push_back(attr);
+            node->children[value] = build_tree(children[value], remaining_attributes, depth + 1);
         }
     }
-    for(const auto & value : attribute_values)
+
+    return node;
+}
+
+// Moves the rows of node to the range of child row_child[row], in place in the training rows and
+// the sorted rows of the remaining numerical attributes. Every array keeps the order of its rows
+// within a child, the dropped rows end up behind the children. Returns the child ranges.
+vector<NodeRows> DecisionTree::partition_node(NodeRows & node, int child_count, const vector<int> & attributes)
+{
+    // child_begin[child] is where the range of child starts, the dropped rows count as child child_count
+    vector<int> child_begin(child_count + 2, 0);
+    for(int i = node.begin; i < node.end; i++)
     {
-        vector<DataPoint> subset;
-        for(const auto & point : data)
+        int child = row_child[training_rows[i]];
+        child_begin[(child < 0 ? child_count : child) + 1]++;
+    }
+    child_begin[0] = node.begin;
+    for(int child = 0; child <= child_count; child++) child_begin[child + 1] += child_begin[child];
+
+    vector<int> next(child_count + 1);
+    auto partition_rows = [&](vector<int> & rows) {
+        copy(child_begin.begin(), child_begin.end() - 1, next.begin());
+        for(int i = node.begin; i < node.end; i++)
+        {
+            int child = row_child[rows[i]];
+            partition_buffer[next[child < 0 ? child_count : child]++] = rows[i];
+        }
+        copy(partition_buffer.begin() + node.begin, partition_buffer.begin() + node.end, rows.begin() + node.begin);
+    };
+    partition_rows(training_rows);
+    for(int attribute : attributes)
+    {
+        if(!sorted_rows[attribute].empty()) partition_rows(sorted_rows[attribute]);
+    }
+
+    vector<NodeRows> children(child_count);
+    for(int child = 0; child < child_count; child++)
+    {
+        children[child].begin = child_begin[child];
+        children[child].end = child_begin[child + 1];
+    }
+    if(histogram_mode)
+    {
+        // count the rows of the smaller children, the largest child is what remains of the parent
+        int largest = 0;
+        for(int child = 0; child < child_count; child++)
+        {
+            children[child].histograms.resize(node.histograms.size());
+            if(children[child].size() > children[largest].size()) largest = child;
+        }
+        NodeRows & rest = children[largest];
+        for(int attribute : attributes)
+        {
+            rest.histograms[attribute] = move(node.histograms[attribute]);
+        }
+        RowRange dropped_rows = {training_rows.data() + child_begin[child_count], training_rows.data() + node.end};
+        count_histograms(dropped_rows, attributes, rest.histograms, -1);
+        for(int child = 0; child < child_count; child++)
         {
-            if(point.attribute_values.at(best_attribute) == value)
+            if(child == largest || children[child].size() == 0) continue;
+            count_histograms(node_rows(children[child]), attributes, children[child].histograms, 1);
+            for(int attribute : attributes)
             {
-                subset.push_back(point); // Collect data points with the current attribute value
+                vector<int> & histogram = rest.histograms[attribute];
+                const vector<int> & sibling = children[child].histograms[attribute];
+                for(size_t i = 0; i < histogram.size(); i++) histogram[i] -= sibling[i];
             }
         }
-        Node * child = build_tree(subset, remaining_attributes, depth + 1);
-        node->children[value] = child;
+        node.histograms.clear();
     }
+    return children;
+}
 
-    return node;
+// Adds sign for every row to the class counts of its bin (or categorical value) in the histogram of every attribute
+void DecisionTree::count_histograms(RowRange rows, const vector<int> & attributes, vector<vector<int>> & histograms, int sign)
+{
+    int class_count = dataset->class_count();
+    const vector<int> & class_labels = dataset->class_labels;
+    for(int attribute : attributes)
+    {
+        vector<int> & histogram = histograms[attribute];
+        if(dataset->attribute_types[attribute] == NUMERICAL)
+        {
+            histogram.resize(HISTOGRAM_BINS * class_count, 0);
+            const vector<uint8_t> & bins = dataset->bin_values[attribute];
+            for(int row : rows) histogram[bins[row] * class_count + class_labels[row]] += sign;
+        }
+        else
+        {
+            histogram.resize(dataset->value_names[attribute].size() * class_count, 0);
+            const vector<int> & values = dataset->categorical_values[attribute];
+            for(int row : rows) histogram[values[row] * class_count + class_labels[row]] += sign;
+        }
+    }
 }
 
-string DecisionTree::predict(const DataPoint & point)
+int DecisionTree::predict(const Dataset & data, int row)
 {
     if(root == nullptr)
     {
         cerr << "Error: Decision tree has not been trained." << endl;
-        return ""; // Return empty string if tree is not trained
+        return -1;
     }
     Node * current_node = root;
     while(!current_node->is_leaf)
     {
-        const string & attribute_name = current_node->attribute_name;
+        int attribute = current_node->attribute;
 
-        if (attribute_value_types[attribute_name] == NUMERICAL)
+        if (data.attribute_types[attribute] == NUMERICAL)
         {
-            // get split threshold from the node's children
-            double split_value = numeric_limits<double>::quiet_NaN();
-            for (const auto & value_node_pair : current_node->children)
-            {
-                size_t pos = value_node_pair.first.find_first_of("0123456789");
-                if (pos != string::npos) 
-                { 
-                    split_value = stod(value_node_pair.first.substr(pos)); 
-                    break; 
-                }
-            }
-            if (isnan(split_value)) // not a number
-            {
-                return "";
-            }
-
-            double attribute_value = 0.0;
-            try { 
-                attribute_value = stod(point.attribute_values.at(attribute_name)); 
-            }
-            catch (...) { 
-                return ""; 
-            }
-
-            string child_indicator; // indicates whether to go to left or right child
-            if(attribute_value < split_value)
-            {
-                child_indicator = "<"  + to_string(split_value);
-            }
-            else 
-            {
-                child_indicator = ">=" + to_string(split_value);
-            }
-            unordered_map<string, Node*>::const_iterator it = current_node->children.find(child_indicator);
-            if (it == current_node->children.end()) 
+            double attribute_value = data.numeric_values[attribute][row];
+            if (isnan(attribute_value)) // not a number
             {
-                return "";
+                return -1;
             }
-            current_node = it->second;
+            current_node = current_node->children[attribute_value < current_node->split_value ? 0 : 1];
         }
-        else // categorical attribute, previous code only wrapped in a else block
+        else
         {
-            string attribute_value = point.attribute_values.at(attribute_name);
-            if(current_node->children.find(attribute_value) != current_node->children.end())
+            int value = data.categorical_values[attribute][row];
+            if(value < (int)current_node->children.size() && current_node->children[value] != nullptr)
             {
-                current_node = current_node->children[attribute_value]; // Move to the child node corresponding to the attribute value
+                current_node = current_node->children[value]; // Move to the child node corresponding to the attribute value
             }
             else
             {
-                cerr << "Warning: Attribute value '" << attribute_value << "' not found in the decision tree." << endl;
-                return ""; // Return empty string if attribute value is not found
+                cerr << "Warning: Attribute value '" << data.value_names[attribute][value] << "' not found in the decision tree." << endl;
+                return -1;
             }
         }
     }
-    return current_node->predicted_class; // Return the predicted class label at the leaf node
+    return current_node->predicted_class; // Return the predicted class id at the leaf node
 }
 
-bool DecisionTree::is_pure_node(const vector<DataPoint> & data)
+bool DecisionTree::is_pure_node(RowRange rows)
 {
-    if(data.empty()) return false; // Empty data cannot be pure
-    string first_class = data[0].class_label;
-    for(const auto & point : data)
+    if(rows.empty()) return false; // Empty data cannot be pure
+    int first_class = dataset->class_labels[rows[0]];
+    for(int row : rows)
     {
-        if(point.class_label != first_class)
+        if(dataset->class_labels[row] != first_class)
         {
             return false; // Found a different class label, not pure
         }
@@ -286,169 +454,166 @@ bool DecisionTree::is_pure_node(const vector<DataPoint> & data)
     return true; // Didn't find any different class labels, so it's pure
 }
 
-string DecisionTree::get_majority_class(const vector<DataPoint> & data)
+int DecisionTree::get_majority_class(RowRange rows)
 {
-    unordered_map<string, int> class_counts;
-    for(const auto & point : data)
-    {
-        class_counts[point.class_label]++;
-    }
-    string majority_class;
-    int max_count = 0;
-    for(const auto & pair : class_counts)
-    {
-        if(pair.second > max_count)
-        {
-            max_count = pair.second;
-            majority_class = pair.first;
-        }
-    }
-    return majority_class; // Return the class label with the highest count
+    vector<int> class_counts = count_classes(rows);
+    return max_element(class_counts.begin(), class_counts.end()) - class_counts.begin(); // lowest class id on ties
 }
 
-string DecisionTree::get_best_attribute(const vector<DataPoint> & data, const vector<string> & attributes)
+int DecisionTree::get_best_attribute(const NodeRows & node, const vector<int> & attributes)
 {
+    // score the attributes, spread over the pool when the node is large enough, then reduce in attribute
+    // order so ties go to the first attribute whatever the number of threads
+    vector<double> values(attributes.size());
+    function<void(int)> score = [&](int i) { values[i] = (this->*attribute_selection_strategy)(node, attributes[i]); };
+    int workers = pool ? node.size() / PARALLEL_MIN_ROWS : 1;
+    if(workers > 1) pool->parallel_for(attributes.size(), workers, score);
+    else for(size_t i = 0; i < attributes.size(); i++) score(i);
+
     double best_value = -1.0;
-    string best_attribute;
-    for(const auto & attribute : attributes)
+    int best_attribute = -1;
+    for(size_t i = 0; i < attributes.size(); i++)
     {
-        double value = (this->*attribute_selection_strategy)(data, attribute);
-        if(value > best_value)
+        if(values[i] > best_value)
         {
-            best_value = value;
-            best_attribute = attribute;
+            best_value = values[i];
+            best_attribute = attributes[i];
         }
     }
-    cout << "Best value for attribute '" << best_attribute << "': " << best_value << endl;
+    cout << "Best value for attribute '" << (best_attribute < 0 ? "" : dataset->attributes[best_attribute]) << "': " << best_value << endl;
     return best_attribute;
 }
 
 
 
+// counting
 
-
-// selection criteria
-
-double DecisionTree::entropy(const vector<DataPoint> & data)
+vector<int> DecisionTree::count_classes(RowRange rows)
 {
-    if(data.empty()) return 0.0;
-
-    unordered_map<string, int> class_counts;
-
-    for(const auto & point : data)
+    vector<int> class_counts(dataset->class_count(), 0);
+    for(int row : rows)
     {
-        class_counts[point.class_label]++;
+        class_counts[dataset->class_labels[row]]++;
     }
+    return class_counts;
+}
 
-    double entropy_value = 0.0;
-    int total_count = data.size();
-    for(const auto & pair : class_counts)
+vector<int> DecisionTree::count_value_classes(const NodeRows & node, int attribute)
+{
+    if(histogram_mode) return node.histograms[attribute];
+    RowRange rows = node_rows(node);
+    int class_count = dataset->class_count();
+    const vector<int> & column = dataset->categorical_values[attribute];
+    vector<int> counts(dataset->value_names[attribute].size() * class_count, 0);
+    for(int row : rows)
     {
-        double probability = static_cast<double>(pair.second) / total_count;
-        entropy_value -= probability * log2(probability);
+        counts[column[row] * class_count + dataset->class_labels[row]]++;
     }
-    return entropy_value;
+    return counts;
 }
 
-double DecisionTree::information_gain(const vector<DataPoint> & data, const string & attribute)
+int DecisionTree::count_unique_values(const NodeRows & node, int attribute)
 {
-    double total_entropy = entropy(data);
-
-    if (attribute_value_types[attribute] == NUMERICAL)
+    if(dataset->attribute_types[attribute] == CATEGORICAL)
+    {
+        vector<char> seen(dataset->value_names[attribute].size(), 0);
+        for(int row : node_rows(node)) seen[dataset->categorical_values[attribute][row]] = 1;
+        return count(seen.begin(), seen.end(), 1);
+    }
+    if(histogram_mode) // bins stand in for values
+    {
+        const vector<int> & histogram = node.histograms[attribute];
+        int class_count = dataset->class_count();
+        int unique_values = 0;
+        for(size_t bin = 0; bin < histogram.size(); bin += class_count)
+        {
+            unique_values += any_of(histogram.begin() + bin, histogram.begin() + bin + class_count, [](int count) { return count > 0; });
+        }
+        return unique_values;
+    }
+    const vector<double> & column = dataset->numeric_values[attribute];
+    RowRange sorted_rows = sorted_node_rows(node, attribute);
+    int unique_values = node.size() > sorted_rows.size(); // values that are not numbers count as one value
+    for(int i = 0; i < sorted_rows.size(); i++)
     {
-        auto [value, gain] = get_best_split_value_and_gain(data, attribute);
-        return gain;
+        if(i == 0 || column[sorted_rows[i]] != column[sorted_rows[i-1]]) unique_values++;
     }
+    return unique_values;
+}
 
-    // categorical, previous code   
-    unordered_map<string, vector<DataPoint>> subsets;
-    for(const auto & point : data)
+
+
+// selection criteria
+
+double DecisionTree::entropy(RowRange rows)
+{
+    if(rows.empty()) return 0.0;
+    vector<int> class_counts = count_classes(rows);
+    return partition_entropy(class_counts.data(), rows.size());
+}
+
+double DecisionTree::information_gain(const NodeRows & node, int attribute)
+{
+    RowRange rows = node_rows(node);
+    if (dataset->attribute_types[attribute] == NUMERICAL)
     {
-        subsets[point.attribute_values.at(attribute)].push_back(point);
+        return get_best_split_value_and_gain(node, attribute).gain;
     }
+
+    double total_entropy = entropy(rows);
+    int class_count = dataset->class_count();
+    vector<int> counts = count_value_classes(node, attribute);
     double weighted_entropy = 0.0;
-    int total_count = data.size();
-    for(const auto & pair : subsets)
+    int total_count = rows.size();
+    for(size_t value = 0; value < counts.size(); value += class_count)
     {
-        double subset_entropy = entropy(pair.second);
-        weighted_entropy += (static_cast<double>(pair.second.size()) / total_count) * subset_entropy;
+        int subset_size = 0;
+        for(int c = 0; c < class_count; c++) subset_size += counts[value + c];
+        if(subset_size == 0) continue;
+        double subset_entropy = partition_entropy(&counts[value], subset_size);
+        weighted_entropy += (static_cast<double>(subset_size) / total_count) * subset_entropy;
     }
     return total_entropy - weighted_entropy;
 }
 
-double DecisionTree::information_gain_ratio(const vector<DataPoint> & data, const string & attribute)
+double DecisionTree::information_gain_ratio(const NodeRows & node, int attribute)
 {
-    if(attribute_value_types[attribute] == NUMERICAL)
+    RowRange rows = node_rows(node);
+    if(dataset->attribute_types[attribute] == NUMERICAL)
     {
-        auto [value, gain] = get_best_split_value_and_gain(data, attribute);
-        int left_subset_size = 0, right_subset_size = 0;
-        for(const auto & point : data)
-        {
-            try
-            {
-                double attribute_value = stod(point.attribute_values.at(attribute));
-                if(attribute_value < value) left_subset_size++;
-                else right_subset_size++;
-            }
-            catch (...) {} // skip points with invalid numeric values
-        }
+        SplitPoint split = get_best_split_value_and_gain(node, attribute);
+        double gain = split.gain;
+        int left_subset_size = split.left_size, right_subset_size = split.right_size; // points with invalid numeric values are on neither side
         if(left_subset_size == 0 || right_subset_size == 0) return 0.0; // Avoid division by zero if no split is possible
-        double left_size_ratio = static_cast<double>(left_subset_size) / data.size();
-        double right_size_ratio = static_cast<double>(right_subset_size) / data.size();
+        double left_size_ratio = static_cast<double>(left_subset_size) / rows.size();
+        double right_size_ratio = static_cast<double>(right_subset_size) / rows.size();
         double intrinsic_value = - (left_size_ratio * log2(left_size_ratio) + right_size_ratio * log2(right_size_ratio));
         if(intrinsic_value == 0) return 0.0; // Avoid division by zero
         return gain / intrinsic_value; // Return information gain ratio
     }
-    double total_entropy = entropy(data);
-    unordered_map<string, vector<DataPoint>> subsets;
-    for(const auto & point : data)
-    {
-        subsets[point.attribute_values.at(attribute)].push_back(point);
-    }
-    double weighted_entropy = 0.0;
-    int total_count = data.size();
-    for(const auto & pair : subsets)
-    {
-        double subset_entropy = entropy(pair.second);
-        weighted_entropy += (static_cast<double>(pair.second.size()) / total_count) * subset_entropy;
-    }
-    double gain = total_entropy - weighted_entropy;
+    double gain = information_gain(node, attribute);
     // Calculate intrinsic value
+    int class_count = dataset->class_count();
+    vector<int> counts = count_value_classes(node, attribute);
+    int total_count = rows.size();
     double intrinsic_value = 0.0;
-    for(const auto & pair : subsets)
+    for(size_t value = 0; value < counts.size(); value += class_count)
     {
-        double size_ratio = static_cast<double>(pair.second.size()) / total_count;
+        int subset_size = 0;
+        for(int c = 0; c < class_count; c++) subset_size += counts[value + c];
+        if(subset_size == 0) continue;
+        double size_ratio = static_cast<double>(subset_size) / total_count;
         intrinsic_value -= size_ratio * log2(size_ratio);
     }
     if(intrinsic_value == 0) return 0.0; // Avoid division by zero
     return gain / intrinsic_value; // Return information gain ratio
 }
 
-double DecisionTree::normalized_weighted_information_gain(const vector<DataPoint> & data, const string & attribute)
+double DecisionTree::normalized_weighted_information_gain(const NodeRows & node, int attribute)
 {
-    if(attribute_value_types[attribute] == NUMERICAL)
-    {
-        auto [value, gain] = get_best_split_value_and_gain(data, attribute);
-        unordered_set<string> unique_values;
-        for(const auto & point : data)
-        {
-            unique_values.insert(point.attribute_values.at(attribute));
-        }
-        int k = unique_values.size();
-        double normalized_gain = 1 - (k - 1) / static_cast<double>(data.size());
-        normalized_gain = gain * normalized_gain;
-        normalized_gain = normalized_gain / log2(k + 1);
-        return normalized_gain;
-    }
-    double information_gain_value = information_gain(data, attribute);
-    int k; // Number of unique values for the attribute
-    unordered_set<string> unique_values;
-    for(const auto & point : data)
-    {
-        unique_values.insert(point.attribute_values.at(attribute));
-    }
-    k = unique_values.size();
-    double normalized_gain = 1 - (k - 1) / static_cast<double>(data.size());
+    double information_gain_value = information_gain(node, attribute);
+    int k = count_unique_values(node, attribute); // Number of unique values for the attribute
+    double normalized_gain = 1 - (k - 1) / static_cast<double>(node.size());
     normalized_gain = information_gain_value * normalized_gain;
     normalized_gain = normalized_gain / log2(k + 1);
     return normalized_gain;
@@ -456,91 +621,153 @@ double DecisionTree::normalized_weighted_information_gain(const vector<DataPoint
 
 // for numeric attributes
 
-double DecisionTree::partition_entropy(const unordered_map<string, int> & class_counts, double total_size)
+double DecisionTree::partition_entropy(const int * class_counts, double total_size)
 {
     if (total_size == 0) // avoid division by zero
     {
         return 0.0;
     }
     double entropy_value = 0.0;
-    for (const auto & pair : class_counts)
+    for (int c = 0; c < dataset->class_count(); c++)
     {
-        double probability = pair.second / total_size;
+        if (class_counts[c] == 0) continue;
+        double probability = class_counts[c] / total_size;
         entropy_value -= probability * log2(probability);
     }
-    return entropy_value;   
+    return entropy_value;
 }
 
-pair<double, double> DecisionTree::get_best_split_value_and_gain(const vector<DataPoint> & data, const string & attribute)
+SplitPoint DecisionTree::get_best_split_value_and_gain(const NodeRows & node, int attribute)
 {
-    vector<pair<double, string>> rows; // value - class label pairs
-    for (const auto & point : data)
-    {
-        try { 
-            rows.push_back({stod(point.attribute_values.at(attribute)), point.class_label}); 
-        }
-        catch (...) {}
-    }
+    if (histogram_mode) return get_best_split_from_histogram(node, attribute);
 
-    if (rows.size() < 2) 
-    { 
-        return {0.0, 0.0}; // Not enough data to split
-    }
-
-    sort(rows.begin(), rows.end(), [](const pair<double, string> & a, const pair<double, string> & b){ return a.first < b.first; });
+    const vector<double> & column = dataset->numeric_values[attribute];
+    RowRange rows = sorted_node_rows(node, attribute); // presorted by value, no sorting here
+    const vector<int> & class_labels = dataset->class_labels;
 
+    SplitPoint best;
+    best.right_size = rows.size();
+    if (rows.size() < 2)
+    {
+        return best; // Not enough data to split
+    }
 
-    unordered_map<string, int> right_class_counts; // counts of class labels in the right partition
-    unordered_map<string, int> left_class_counts; // counts of class labels in the left partition
-    for (const auto & row : rows) // initially all records are in the right partition
+    vector<int> right_class_counts(dataset->class_count(), 0); // counts of class labels in the right partition
+    vector<int> left_class_counts(dataset->class_count(), 0); // counts of class labels in the left partition
+    for (int row : rows) // initially all records are in the right partition
     {
-        right_class_counts[row.second]++;
+        right_class_counts[class_labels[row]]++;
     }
 
-    const double total_entropy = partition_entropy(right_class_counts, rows.size());
+    const double total_entropy = partition_entropy(right_class_counts.data(), rows.size());
 
-    double best_gain = -1.0, best_split_value = rows.front().first;
+    double best_gain = -1.0, best_split_value = column[rows[0]];
+    int run_start = 0; // first row with the value of row i
 
-    for (size_t i = 0; i < rows.size() - 1; i++)
+    for (int i = 0; i < rows.size() - 1; i++)
     {
         /* move record i → left */
-        left_class_counts[rows[i].second]++;
-        right_class_counts[rows[i].second]--;
-        if (right_class_counts[rows[i].second] == 0)
-        {
-            right_class_counts.erase(rows[i].second);
-        }
+        left_class_counts[class_labels[rows[i]]]++;
+        right_class_counts[class_labels[rows[i]]]--;
 
-        if (rows[i].second == rows[i+1].second) continue;  // no class change
+        double value = column[rows[i]], next_value = column[rows[i+1]];
+        if (i > 0 && value != column[rows[i-1]]) run_start = i;
+        if (class_labels[rows[i]] == class_labels[rows[i+1]]) continue;  // no class change
 
-        double split_value = (rows[i].first + rows[i+1].first) / 2.0;
+        double split_value = (value + next_value) / 2.0;
         double number_of_left_classes = i + 1, number_of_right_classes = rows.size() - number_of_left_classes;
-        double gain = total_entropy - (number_of_left_classes / rows.size()) * partition_entropy(left_class_counts , number_of_left_classes) - (number_of_right_classes / rows.size()) * partition_entropy(right_class_counts, number_of_right_classes);
+        double gain = total_entropy - (number_of_left_classes / rows.size()) * partition_entropy(left_class_counts.data(), number_of_left_classes) - (number_of_right_classes / rows.size()) * partition_entropy(right_class_counts.data(), number_of_right_classes);
 
         if (gain > best_gain)
         {
             best_split_value = split_value;
             best_gain = gain;
+            best.left_size = value == next_value ? run_start : i + 1; // rows below the threshold
+        }
+    }
+
+    best.value = best_split_value;
+    best.gain = max(0.0, best_gain);
+    best.right_size = rows.size() - best.left_size;
+    return best;
+}
+
+// The same search over the bins of the node histogram, thresholds lie between nonempty bins
+SplitPoint DecisionTree::get_best_split_from_histogram(const NodeRows & node, int attribute)
+{
+    const vector<int> & histogram = node.histograms[attribute];
+    const vector<double> & thresholds = dataset->bin_thresholds[attribute];
+    int class_count = dataset->class_count();
+    int bin_count = thresholds.size() + 1;
+
+    vector<int> right_class_counts(class_count, 0), left_class_counts(class_count, 0);
+    int total_size = 0;
+    for (int bin = 0; bin < bin_count; bin++) // values that are not numbers are left out
+    {
+        for (int c = 0; c < class_count; c++) right_class_counts[c] += histogram[bin * class_count + c];
+    }
+    for (int count : right_class_counts) total_size += count;
+
+    SplitPoint best;
+    best.right_size = total_size;
+    if (total_size < 2)
+    {
+        return best; // Not enough data to split
+    }
+
+    const double total_entropy = partition_entropy(right_class_counts.data(), total_size);
+    double best_gain = -1.0;
+    int left_size = 0, previous_bin = -1;
+    for (int bin = 0; bin < bin_count; bin++)
+    {
+        const int * counts = &histogram[bin * class_count];
+        int bin_size = 0;
+        for (int c = 0; c < class_count; c++) bin_size += counts[c];
+        if (bin_size == 0) continue;
+
+        if (previous_bin >= 0) // split between previous_bin and bin
+        {
+            double number_of_left_classes = left_size, number_of_right_classes = total_size - left_size;
+            double gain = total_entropy - (number_of_left_classes / total_size) * partition_entropy(left_class_counts.data(), number_of_left_classes) - (number_of_right_classes / total_size) * partition_entropy(right_class_counts.data(), number_of_right_classes);
+            if (gain > best_gain)
+            {
+                best_gain = gain;
+                best.value = thresholds[previous_bin];
+                best.left_size = left_size;
+            }
         }
+
+        for (int c = 0; c < class_count; c++)
+        {
+            left_class_counts[c] += counts[c];
+            right_class_counts[c] -= counts[c];
+        }
+        left_size += bin_size;
+        previous_bin = bin;
     }
 
-    best_gain = max(0.0, best_gain);
-    return {best_split_value, best_gain};
+    best.gain = max(0.0, best_gain);
+    best.right_size = total_size - best.left_size;
+    return best;
 }
 
 // print
-void DecisionTree::print_tree(Node* node, int tree_depth) 
+void DecisionTree::print_tree(Node* node, int tree_depth)
 {
     if (node == nullptr) return;
-    
+
     std::string indent(tree_depth * 4, ' ');
     if (node->is_leaf) {
-        std::cout << indent << "-> Predict: " << node->predicted_class << "\n";
+        std::cout << indent << "-> Predict: " << dataset->class_names[node->predicted_class] << "\n";
     } else {
-        std::cout << indent << "Split on: " << node->attribute_name << "?\n";
-        for (const auto& pair : node->children) {
-            std::cout << indent << "    - " << pair.first << ":\n";
-            print_tree(pair.second, tree_depth + 1);
+        std::cout << indent << "Split on: " << dataset->attributes[node->attribute] << "?\n";
+        for (size_t i = 0; i < node->children.size(); i++) {
+            if (node->children[i] == nullptr) continue;
+            string label;
+            if (dataset->attribute_types[node->attribute] == NUMERICAL) label = (i == 0 ? "<" : ">=") + to_string(node->split_value);
+            else label = dataset->value_names[node->attribute][i];
+            std::cout << indent << "    - " << label << ":\n";
+            print_tree(node->children[i], tree_depth + 1);
         }
     }
 }
@@ -554,11 +781,11 @@ int DecisionTree::get_tree_depth_helper(Node * node)
 {
     if (node == nullptr) return 0;
     if (node->is_leaf) return node->current_depth;
-    
+
     int depth = 0;
-    for (const auto & child : node->children)
+    for (auto child : node->children)
     {
-        depth = max(depth, get_tree_depth_helper(child.second));
+        depth = max(depth, get_tree_depth_helper(child));
     }
     return depth;
 }
@@ -567,9 +794,9 @@ int DecisionTree::get_tree_size_helper(Node * node)
 {
     if (node == nullptr) return 0;
     int size = 1; // Count the current node
-    for (const auto & child : node->children)
+    for (auto child : node->children)
     {
-        size += get_tree_size_helper(child.second); // Recursively count child nodes
+        size += get_tree_size_helper(child); // Recursively count child nodes
     }
     return size;
 }
@@ -3,63 +3,68 @@
 
 using namespace std;
 
-unordered_map<string, AttributeType> attribute_value_types;
-
 int main(int argc, char *argv[])
 {
     int max_depth = 5;
     string selection_strategy = "ig";
-    if(argc == 3)
+    bool histogram_mode = false; // optional third argument "histogram"
+    if(argc >= 3)
     {
         max_depth = stoi(argv[2]);
         selection_strategy = argv[1];
     }
+    if(argc >= 4 && string(argv[3]) == "histogram")
+    {
+        histogram_mode = true;
+    }
 
-    vector<DataPoint> data;
-    vector<string> attributes;
-    string class_label_name;
+    Dataset data;
 
     const string file_name = "iris"; // Change this to "adult" for the adult dataset
 
     if(file_name == "iris")
     {
-        read_iris_file(data, attributes, class_label_name, attribute_value_types);
+        read_iris_file(data);
     }
     else if(file_name == "adult")
     {
-        read_adult_file(data, attributes, class_label_name, attribute_value_types);
+        read_adult_file(data);
     }
 
-    DecisionTree tree(max_depth, selection_strategy, attribute_value_types);
+    if(histogram_mode)
+    {
+        quantize_numeric_columns(data);
+    }
+    DecisionTree tree(max_depth, selection_strategy, histogram_mode, thread::hardware_concurrency());
 
-    vector<DataPoint> training_data, test_data;
-    split_data(data, training_data, test_data);
+    vector<int> training_rows, test_rows;
+    split_data(data, training_rows, test_rows);
 
-    tree.train(training_data, attributes);
+    tree.train(data, training_rows);
     tree.print();
 
     int correct_predictions_with_training_data = 0;
-    for(const auto & point : training_data)
+    for(int row : training_rows)
     {
-        string predicted_class = tree.predict(point);
-        if(predicted_class == point.class_label)
+        int predicted_class = tree.predict(data, row);
+        if(predicted_class == data.class_labels[row])
         {
             correct_predictions_with_training_data++;   
         }
     }
 
-    double training_accuracy = static_cast<double>(correct_predictions_with_training_data) / training_data.size() * 100.0;
+    double training_accuracy = static_cast<double>(correct_predictions_with_training_data) / training_rows.size() * 100.0;
     cout << "Training accuracy: " << training_accuracy << "%" << endl;
     int correct_predictions_with_test_data = 0;
-    for(const auto & point : test_data)
+    for(int row : test_rows)
     {
-        string predicted_class = tree.predict(point);
-        if(predicted_class == point.class_label)
+        int predicted_class = tree.predict(data, row);
+        if(predicted_class == data.class_labels[row])
         {
             correct_predictions_with_test_data++;
         }
     }
-    double test_accuracy = static_cast<double>(correct_predictions_with_test_data) / test_data.size() * 100.0;
+    double test_accuracy = static_cast<double>(correct_predictions_with_test_data) / test_rows.size() * 100.0;
     cout << "Test accuracy: " << test_accuracy << "%" << endl;
 
     return 0;
@@ -1,31 +1,32 @@
 #ifndef node_hpp
 #define node_hpp
 
-#include <string>
-#include <unordered_map>
+#include <vector>
 using namespace std;
 
-struct Node 
+struct Node
 {
     bool is_leaf; // true if the current node is a leaf node
-    string attribute_name; // attribute name selected for splitting
-    string predicted_class; // class label if this is a leaf node
+    int attribute; // column of the attribute selected for splitting, -1 for a leaf node
+    double split_value; // numerical split: children[0] takes values < split_value, children[1] the rest
+    int predicted_class; // class id if this is a leaf node
     int current_depth;
-    unordered_map<string, Node*> children; // map of attribute values to child nodes
+    vector<Node*> children; // numerical split: {left, right}, categorical split: child per value id, nullptr for values the node did not see
 
-    Node(bool leaf = false, const string& attr_name = "", const string& class_label = "", int depth = 0)
+    Node(bool leaf = false, int attribute = -1, int class_label = -1, int depth = 0)
     {
         is_leaf = leaf;
-        attribute_name = attr_name;
+        this->attribute = attribute;
+        split_value = 0.0;
         predicted_class = class_label;
         current_depth = depth;
     }
 
     ~Node()
     {
-        for (auto& child : children)
+        for (auto child : children)
         {
-            delete child.second; // recursively delete child nodes
+            delete child; // recursively delete child nodes
         }
     }
 
@@ -33,4 +34,4 @@ struct Node
     Node& operator=(const Node&) = delete; // disable copy assignment operator
 };
 
-#endif // node_hpp
\ No newline at end of file
+#endif // node_hpp
@@ -11,7 +11,7 @@ ofstream node_depth_csv_file("node_depth.csv");
 
 
 
-void get_accuracy(const vector<DataPoint> & data, vector<string> & attributes, int max_depth, const string & selection_strategy, double & average_training_accuracy, double & average_test_accuracy, unordered_map<string, AttributeType> & attribute_value_types, int & node_count, int & depth_count)
+void get_accuracy(const Dataset & data, int max_depth, const string & selection_strategy, double & average_training_accuracy, double & average_test_accuracy, int & node_count, int & depth_count)
 {
     double test_accuracy = 0.0;
     double training_accuracy = 0.0;
@@ -20,35 +20,35 @@ void get_accuracy(const vector<DataPoint> & data, vector<string> & attributes, i
 
     for(int i = 0; i < 20; i++)
     {
-        DecisionTree tree(max_depth, selection_strategy, attribute_value_types);
-        vector<DataPoint> training_data, test_data;
-        split_data(data, training_data, test_data);
-        tree.train(training_data, attributes);
+        DecisionTree tree(max_depth, selection_strategy);
+        vector<int> training_rows, test_rows;
+        split_data(data, training_rows, test_rows);
+        tree.train(data, training_rows);
         if(max_depth == 0)
         {
             nodes += tree.get_tree_size();
             depths += tree.get_tree_depth();
         }
         int correct_predictions_with_training_data = 0;
-        for(const auto & point : training_data)
+        for(int row : training_rows)
         {
-            string predicted_class = tree.predict(point);
-            if(predicted_class == point.class_label)
+            int predicted_class = tree.predict(data, row);
+            if(predicted_class == data.class_labels[row])
             {
                 correct_predictions_with_training_data++;
             }
         }
-        training_accuracy += static_cast<double>(correct_predictions_with_training_data) / training_data.size();
+        training_accuracy += static_cast<double>(correct_predictions_with_training_data) / training_rows.size();
         int correct_predictions_with_test_data = 0;
-        for(const auto & point : test_data)
+        for(int row : test_rows)
         {
-            string predicted_class = tree.predict(point);
-            if(predicted_class == point.class_label)
+            int predicted_class = tree.predict(data, row);
+            if(predicted_class == data.class_labels[row])
             {
                 correct_predictions_with_test_data++;
             }
         }
-        test_accuracy += static_cast<double>(correct_predictions_with_test_data) / test_data.size();
+        test_accuracy += static_cast<double>(correct_predictions_with_test_data) / test_rows.size();
     }
 
     average_training_accuracy = training_accuracy / 20.0;
@@ -70,17 +70,14 @@ void generate_csv(string selection_strategy, string file_name)
 
     csv_file << "Max Depth,Training Accuracy,Test Accuracy\n";
     csv_file.flush(); // Ensure header is written to the file immediately
-    vector<DataPoint> data;
-    vector<string> attributes;
-    string class_label_name;
-    unordered_map<string, AttributeType> attribute_value_types;
+    Dataset data;
     if(file_name == "iris")
     {
-        read_iris_file(data, attributes, class_label_name, attribute_value_types);
+        read_iris_file(data);
     }
     else if(file_name == "adult")
     {
-        read_adult_file(data, attributes, class_label_name, attribute_value_types);
+        read_adult_file(data);
     }
     else
     {
@@ -94,7 +91,7 @@ void generate_csv(string selection_strategy, string file_name)
         double average_test_accuracy = 0.0;
         int node_count = 0;
         int depth_count = 0;
-        get_accuracy(data, attributes, max_depth, selection_strategy, average_training_accuracy, average_test_accuracy, attribute_value_types, node_count, depth_count);
+        get_accuracy(data, max_depth, selection_strategy, average_training_accuracy, average_test_accuracy, node_count, depth_count);
         csv_file << max_depth << "," << average_training_accuracy << "," << average_test_accuracy << "\n";
         csv_file.flush(); // Ensure data is written to the file immediately
 
@@ -0,0 +1,104 @@
+#ifndef thread_pool_hpp
+#define thread_pool_hpp
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+using namespace std;
+
+// Worker threads that stay alive between parallel loops, so a loop costs a wake up instead of thread creation.
+// parallel_for hands out the indices through a shared counter and the calling thread works on them too.
+class ThreadPool
+{
+    vector<thread> workers;
+    mutex lock;
+    condition_variable work_ready, work_done;
+    const function<void(int)> * task = nullptr;
+    int task_count = 0;
+    atomic<int> next_index{0};
+    long long generation = 0; // number of the current loop, workers wait for a new one
+    int helpers_wanted = 0; // workers that may still join the current loop
+    int helpers_running = 0; // workers inside the current loop
+    bool stopping = false;
+
+    void run_task()
+    {
+        for(int i = next_index++; i < task_count; i = next_index++) (*task)(i);
+    }
+
+    void work()
+    {
+        unique_lock<mutex> guard(lock);
+        long long seen_generation = 0;
+        while(true)
+        {
+            work_ready.wait(guard, [&]() { return stopping || generation != seen_generation; });
+            if(stopping) return;
+            seen_generation = generation;
+            if(helpers_wanted == 0) continue; // the loop has enough threads, or is over already
+            helpers_wanted--;
+            helpers_running++;
+            guard.unlock();
+            run_task();
+            guard.lock();
+            if(--helpers_running == 0) work_done.notify_all();
+        }
+    }
+
+    public:
+    ThreadPool(int threads) // the calling thread counts as one of them
+    {
+        for(int i = 1; i < threads; i++)
+        {
+            workers.emplace_back(&ThreadPool::work, this);
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        work_ready.notify_all();
+        for(auto & worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    int size() const { return workers.size() + 1; }
+
+    // Runs task(i) for every i in [0, count) on up to threads threads, returns when all are done
+    void parallel_for(int count, int threads, const function<void(int)> & loop_task)
+    {
+        threads = max(1, min({threads, count, size()}));
+        if(threads == 1)
+        {
+            for(int i = 0; i < count; i++) loop_task(i);
+            return;
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            task = &loop_task;
+            task_count = count;
+            next_index = 0;
+            helpers_wanted = threads - 1;
+            generation++;
+        }
+        work_ready.notify_all();
+        run_task();
+
+        // no worker may join once the indices are used up, then wait for the ones that did
+        unique_lock<mutex> guard(lock);
+        helpers_wanted = 0;
+        work_done.wait(guard, [&]() { return helpers_running == 0; });
+        task = nullptr;
+    }
+};
+
+#endif // thread_pool_hpp